@@ -0,0 +1,104 @@
+// Fill and resolve cost of the panel framebuffers at 1x, 4x and 8x MSAA.
+//
+// Each frame clears the framebuffer and covers it "layers" times with a
+// full screen triangle, then resolves it. Times are GPU times, measured with
+// glFinish around the work of all the frames.
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "opengl/framebuffer.h"
+#include "opengl/shader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+static const char* vertexCode = R"(#version 330 core
+void main()
+{
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* fragmentCode = R"(#version 330 core
+out vec4 FragColor;
+void main()
+{
+	FragColor = vec4(gl_FragCoord.xy / 2048.0, 0.5, 1.0);
+}
+)";
+
+template<typename F>
+static double milliseconds(F work) {
+    glFinish();
+    auto start = std::chrono::steady_clock::now();
+    work();
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? std::stoi(argv[1]) : 100;
+    const int layers = 4;
+
+    if (!glfwInit())
+        return 1;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "framebuffer_fill_bench", nullptr, nullptr);
+    if (!window)
+        return 1;
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK)
+        return 1;
+
+    Shader shader;
+    shader.init(vertexCode, fragmentCode);
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+
+    std::printf("%-8s %6s %14s %14s %14s\n", "samples", "size", "fill ms/frame", "resolve ms", "Mpixels/s");
+    for (int samples : {1, 4, 8}) {
+        for (unsigned int size : {256u, 512u, 1024u, 2048u}) {
+            Framebuffer framebuffer;
+            framebuffer.create(size, size, samples);
+
+            shader.use();
+            glBindVertexArray(vao);
+            double fill = milliseconds([&]() {
+                for (int frame = 0 ; frame < frames ; ++frame) {
+                    framebuffer.bind();
+                    glViewport(0, 0, size, size);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    for (int layer = 0 ; layer < layers ; ++layer)
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                }
+            });
+            double resolve = milliseconds([&]() {
+                for (int frame = 0 ; frame < frames ; ++frame) {
+                    framebuffer.bind();
+                    framebuffer.resolve();
+                }
+            });
+
+            double pixels = double(size) * size * layers * frames;
+            std::printf("%-8d %6u %14.3f %14.3f %14.0f\n", framebuffer.samples(), size,
+                fill / frames, resolve / frames, pixels / (fill * 1000.0));
+
+            framebuffer.unbind();
+            framebuffer.destroy();
+        }
+    }
+
+    glDeleteVertexArrays(1, &vao);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Load throughput of the mesh formats, in MB/s of file.
+//
+// A grid of "n" x "n" colored vertices (2 (n-1)^2 triangles) is written as an
+// OBJ with quads, an ascii PLY and a binary PLY, then imported with one
+// thread and with one thread per core. The binary format is timed from
+// open() to the copy of its blocks into buffers, which stands for the
+// upload of Mesh::create(). The files are in the page cache: this is the
+// cost of parsing, not of the disk.
+
+#include "opengl/mesh_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double sink = 0.0;
+
+template<typename F>
+static double seconds(F work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// best of a few runs
+template<typename F>
+static double bestSeconds(F work) {
+    double best = seconds(work);
+    for (int i = 0; i < 2; ++i)
+        best = std::min(best, seconds(work));
+    return best;
+}
+
+static void writeFiles(const std::string& directory, int n) {
+    std::ofstream obj(directory + "/grid.obj");
+    std::ofstream ascii(directory + "/grid_ascii.ply");
+    std::ofstream binary(directory + "/grid_binary.ply", std::ios::binary);
+
+    const int vertices = n * n, faces = (n - 1) * (n - 1);
+    ascii << "ply\nformat ascii 1.0\nelement vertex " << vertices
+          << "\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\nproperty uchar green\nproperty uchar blue\n"
+          << "element face " << 2 * faces << "\nproperty list uchar int vertex_indices\nend_header\n";
+    binary << "ply\nformat binary_little_endian 1.0\nelement vertex " << vertices
+           << "\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\nproperty uchar green\nproperty uchar blue\n"
+           << "element face " << 2 * faces << "\nproperty list uchar int vertex_indices\nend_header\n";
+
+    char line[128];
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            float position[3] = {float(i) / (n - 1), float(j) / (n - 1), 0.0f};
+            unsigned char color[3] = {static_cast<unsigned char>(255 * i / (n - 1)), static_cast<unsigned char>(255 * j / (n - 1)), 128};
+            obj.write(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.6f %.6f %.6f\n", position[0], position[1], position[2], color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f));
+            ascii.write(line, std::snprintf(line, sizeof(line), "%.6f %.6f %.6f %d %d %d\n", position[0], position[1], position[2], color[0], color[1], color[2]));
+            binary.write(reinterpret_cast<const char*>(position), sizeof(position));
+            binary.write(reinterpret_cast<const char*>(color), sizeof(color));
+        }
+    for (int j = 0; j + 1 < n; ++j)
+        for (int i = 0; i + 1 < n; ++i) {
+            int a = j * n + i, b = a + 1, c = a + n + 1, d = a + n;
+            obj.write(line, std::snprintf(line, sizeof(line), "f %d %d %d %d\n", a + 1, b + 1, c + 1, d + 1));
+            int triangles[2][3] = {{a, b, c}, {a, c, d}};
+            for (const int* triangle : triangles) {
+                ascii.write(line, std::snprintf(line, sizeof(line), "3 %d %d %d\n", triangle[0], triangle[1], triangle[2]));
+                unsigned char count = 3;
+                binary.write(reinterpret_cast<const char*>(&count), 1);
+                binary.write(reinterpret_cast<const char*>(triangle), 3 * sizeof(int));
+            }
+        }
+}
+
+static bool same(const MeshFile::Data& a, const MeshFile::Data& b) {
+    return a.vertices.size() == b.vertices.size() && a.indices == b.indices
+        && std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Mesh::Vertex)) == 0;
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::stoi(argv[1]) : 1000;
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "yaw_mesh_bench";
+    std::filesystem::create_directories(directory);
+    writeFiles(directory.string(), n);
+
+    std::printf("%d vertices, %d triangles, %d cores\n", n * n, 2 * (n - 1) * (n - 1), cores);
+    std::printf("%-16s %10s %12s %12s\n", "MB/s", "MB", "1 thread", "all cores");
+
+    MeshFile::Data reference;
+    bool ok = true;
+    const char* files[] = {"grid.obj", "grid_ascii.ply", "grid_binary.ply"};
+    for (const char* name : files) {
+        std::string filename = (directory / name).string();
+        double megabytes = std::filesystem::file_size(filename) / 1e6;
+        MeshFile::Data data;
+        double single = bestSeconds([&]() { ok &= MeshFile::import(filename, data, 1); });
+        double parallel = bestSeconds([&]() { ok &= MeshFile::import(filename, data, cores); });
+        std::printf("%-16s %10.1f %12.1f %12.1f\n", name, megabytes, megabytes / single, megabytes / parallel);
+
+        // the PLY colors are bytes, the OBJ ones floats: only the binary
+        // formats are compared vertex for vertex
+        if (reference.indices.empty())
+            reference = data;
+        ok &= data.indices == reference.indices && data.vertices.size() == reference.vertices.size();
+    }
+
+    std::string binary = (directory / "grid.ymesh").string();
+    ok &= MeshFile::convert((directory / "grid_binary.ply").string(), binary);
+    double megabytes = std::filesystem::file_size(binary) / 1e6;
+    std::vector<std::byte> buffer(std::filesystem::file_size(binary));
+    double load = bestSeconds([&]() {
+        MeshFile file;
+        ok &= file.open(binary);
+        std::memcpy(buffer.data(), file.vertices().data(), file.vertices().size_bytes());
+        std::memcpy(buffer.data() + file.vertices().size_bytes(), file.indices().data(), file.indices().size_bytes());
+        sink += std::to_integer<int>(buffer[buffer.size() / 2]);
+    });
+    std::printf("%-16s %10.1f %12.1f\n", "grid.ymesh", megabytes, megabytes / load);
+
+    MeshFile::Data ply, mesh;
+    ok &= MeshFile::import((directory / "grid_binary.ply").string(), ply) && MeshFile::import(binary, mesh);
+    ok &= same(ply, mesh);
+
+    std::filesystem::remove_all(directory);
+    if (!ok)
+        std::printf("MISMATCH\n");
+    return ok ? (sink == 42.0) : 1;
+}
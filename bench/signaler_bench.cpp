@@ -0,0 +1,93 @@
+// Emits per second of the Signaler signals.
+//
+// "legacy" reproduces the previous dispatch (string keyed maps + dynamic_cast
+// per slot), "string" is the compatibility Signaler::emit(name) and "typed"
+// the TypedSignal member emit used on the hot paths.
+
+#include "trackball/Signaler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace legacy {
+
+class AnySignal {
+public:
+    virtual ~AnySignal() {};
+};
+
+class SimpleSignal : public AnySignal {
+public:
+    SimpleSignal(std::function<void()> s) : signal(s) {}
+    void operator()() { signal(); }
+private:
+    std::function<void()> signal;
+};
+
+class Signaler {
+public:
+    Signaler(std::list<std::string> signalsName) {
+        for (auto it = signalsName.begin() ; it != signalsName.end() ; ++it)
+            signals[*it] = std::map<void*, AnySignal*>();
+    }
+    ~Signaler() {
+        for (auto& s : signals)
+            for (auto& c : s.second)
+                delete c.second;
+    }
+    void connect(const std::string& signalName, std::function<void()> callback, void * called) {
+        if (signals.find(signalName) != signals.end())
+            signals[signalName][called] = new SimpleSignal(callback);
+    }
+    void emit(const std::string& signalName) {
+        if (signals.find(signalName) != signals.end())
+            for (auto cit = signals[signalName].begin() ; cit != signals[signalName].end() ; ++cit)
+                dynamic_cast<SimpleSignal*>(cit->second)->operator()();
+    }
+private:
+    std::map<std::string, std::map<void*, AnySignal*> > signals;
+};
+
+}
+
+class Emitter : public Signaler {
+public:
+    Emitter() : Signaler({"interpolated", "endReached", "spun"}) {
+        addSignal("modified", modified);
+    }
+    TypedSignal<> modified;
+};
+
+static volatile unsigned long counter = 0;
+static void slot() { counter = counter + 1; }
+
+template<typename F>
+static double emitsPerSecond(unsigned long n, F emitOnce) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0 ; i < n ; ++i)
+        emitOnce();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return n / elapsed.count();
+}
+
+int main(int argc, char** argv) {
+    const unsigned long n = argc > 1 ? std::stoul(argv[1]) : 5000000;
+    int dummies[8];
+
+    std::printf("%-8s %6s %16s\n", "emit", "slots", "emits/s");
+    for (int slots : {1, 4}) {
+        legacy::Signaler before({"modified", "interpolated", "endReached", "spun"});
+        Emitter after;
+        for (int i = 0 ; i < slots ; ++i) {
+            before.connect("modified", slot, &dummies[i]);
+            after.modified.connect(slot, &dummies[i]);
+        }
+
+        std::printf("%-8s %6d %16.0f\n", "legacy", slots, emitsPerSecond(n, [&]() { before.emit("modified"); }));
+        std::printf("%-8s %6d %16.0f\n", "string", slots, emitsPerSecond(n, [&]() { after.emit("modified"); }));
+        std::printf("%-8s %6d %16.0f\n", "typed", slots, emitsPerSecond(n, [&]() { after.modified.emit(); }));
+    }
+
+    return 0;
+}
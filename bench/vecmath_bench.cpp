@@ -0,0 +1,95 @@
+// Nanoseconds per element of the simd Vec and Quaternion kernels.
+//
+// "scalar" calls the Quaternion methods in a loop, "double" and "float" are
+// the simd kernels in double and single precision. Each kernel runs over
+// arrays of "n" elements, repeated until about 0.2 s have elapsed.
+
+#include "trackball/simdMath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace qglviewer;
+
+static double sink = 0.0;
+
+template<typename F>
+static double nsPerOp(int n, F work) {
+    int repeats = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> elapsed(0);
+    do {
+        work();
+        ++repeats;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 2e8);
+    return elapsed.count() / (double(repeats) * n);
+}
+
+static void report(const char* kernel, double scalar, double dbl, double flt) {
+    std::printf("%-12s %10.2f %10.2f %10.2f %9.1fx %9.1fx\n", kernel, scalar, dbl, flt, scalar / dbl, scalar / flt);
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::stoi(argv[1]) : 4096;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    auto randomQuaternion = [&]() {
+        Quaternion q(unit(rng), unit(rng), unit(rng), unit(rng));
+        q.normalize();
+        return q;
+    };
+
+    std::vector<Quaternion> a(n), b(n), q(n);
+    std::vector<Vec> v(n), rv(n);
+    std::vector<qreal> t(n);
+    std::vector<GLdouble> m(16 * n);
+    for (int i = 0; i < n; ++i) {
+        a[i] = randomQuaternion();
+        b[i] = randomQuaternion();
+        v[i] = Vec(unit(rng), unit(rng), unit(rng));
+        t[i] = 0.5 * (unit(rng) + 1.0);
+    }
+
+    std::vector<simd::Quat4f> af(n), bf(n), qf(n);
+    std::vector<simd::Vec3f> vf(n), rvf(n);
+    std::vector<float> tf(n);
+    std::vector<GLfloat> mf(16 * n);
+    for (int i = 0; i < n; ++i) {
+        af[i] = simd::Quat4f(a[i]);
+        bf[i] = simd::Quat4f(b[i]);
+        vf[i] = simd::Vec3f(v[i]);
+        tf[i] = float(t[i]);
+    }
+    const Quaternion r = a[0];
+    const simd::Quat4f rf(r);
+
+    std::printf("%d elements, %s\n", n, simd::path());
+    std::printf("%-12s %10s %10s %10s %10s %10s\n", "ns/op", "scalar", "double", "float", "double", "float");
+
+    report("multiply",
+           nsPerOp(n, [&]() { for (int i = 0; i < n; ++i) q[i] = a[i] * b[i]; sink += q[n - 1][0]; }),
+           nsPerOp(n, [&]() { simd::multiply(a.data(), b.data(), q.data(), n); sink += q[n - 1][0]; }),
+           nsPerOp(n, [&]() { simd::multiply(af.data(), bf.data(), qf.data(), n); sink += qf[n - 1].x; }));
+
+    report("rotate",
+           nsPerOp(n, [&]() { for (int i = 0; i < n; ++i) rv[i] = r.rotate(v[i]); sink += rv[n - 1].x; }),
+           nsPerOp(n, [&]() { simd::rotate(r, v.data(), rv.data(), n); sink += rv[n - 1].x; }),
+           nsPerOp(n, [&]() { simd::rotate(rf, vf.data(), rvf.data(), n); sink += rvf[n - 1].x; }));
+
+    report("getMatrix",
+           nsPerOp(n, [&]() { for (int i = 0; i < n; ++i) a[i].getMatrix(&m[16 * i]); sink += m[16 * n - 5]; }),
+           nsPerOp(n, [&]() { simd::getMatrices(a.data(), m.data(), n); sink += m[16 * n - 5]; }),
+           nsPerOp(n, [&]() { simd::getMatrices(af.data(), mf.data(), n); sink += mf[16 * n - 5]; }));
+
+    report("slerp",
+           nsPerOp(n, [&]() { for (int i = 0; i < n; ++i) q[i] = Quaternion::slerp(a[i], b[i], t[i]); sink += q[n - 1][0]; }),
+           nsPerOp(n, [&]() { simd::slerp(a.data(), b.data(), t.data(), q.data(), n); sink += q[n - 1][0]; }),
+           nsPerOp(n, [&]() { simd::slerp(af.data(), bf.data(), tf.data(), qf.data(), n); sink += qf[n - 1].x; }));
+
+    return sink == 42.0;
+}
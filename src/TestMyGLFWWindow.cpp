@@ -1,8 +1,8 @@
 #include "TestMyGLFWWindow.h"
 #include <iostream>
 
-TestMyGLFWWindow::TestMyGLFWWindow(const std::string& name, unsigned int w, unsigned int h) :
-    ImGuiGLFWWindow(name,w,h) {
+TestMyGLFWWindow::TestMyGLFWWindow(const std::string& name, unsigned int w, unsigned int h, int samples) :
+    ImGuiGLFWWindow(name,w,h,samples) {
 
 }
 
@@ -11,7 +11,14 @@ bool TestMyGLFWWindow::init() {
     return true;
 }
 
-void TestMyGLFWWindow::drawGL() {
-    triangle.setUniform("color", 1.0f,1.0f,1.0f);
-    triangle.draw();
+void TestMyGLFWWindow::update(UniformBuffer& uniforms) {
+    if (triangle.version() != drawnVersion) {
+        drawnVersion = triangle.version();
+        invalidate();
+    }
+    triangle.update(uniforms);
+}
+
+void TestMyGLFWWindow::drawGL(RenderQueue& queue, RenderQueue::Target target) {
+    triangle.submit(queue, target);
 }
\ No newline at end of file
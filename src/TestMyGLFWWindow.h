@@ -7,14 +7,16 @@
 class TestMyGLFWWindow : public ImGuiGLFWWindow {
 
 public:
-    TestMyGLFWWindow(const std::string& name, unsigned int w, unsigned int h);
+    TestMyGLFWWindow(const std::string& name, unsigned int w, unsigned int h, int samples = 1);
 
 protected :
-    virtual void drawGL();
+    virtual void update(UniformBuffer& uniforms);
+    virtual void drawGL(RenderQueue& queue, RenderQueue::Target target);
     virtual bool init();
 
 private :
       Triangle triangle;
+      unsigned int drawnVersion = 0;
 };
 
 
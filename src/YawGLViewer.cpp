@@ -1,10 +1,28 @@
 #include "YawGLViewer.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
+#include "opengl/triangle.h"
+#include "application/ImGuiGLFWApp.h"
 
 void YawGLViewer::init() {
     setAxisIsDrawn(true);
     setAxisIsDrawn(true);
+
+    instancedShader.init("src/shaders", "instanced-shader", "instanced-shader");
+    instancedShader.bindUniformBlock("Camera", CameraBlock::binding);
+
+    Triangle::create(triangles);
+    const int n = 32;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            Mesh::Instance instance;
+            instance.transform[0] = instance.transform[5] = instance.transform[10] = 0.2f;
+            instance.transform[12] = -1.0f + 2.0f * i / (n - 1);
+            instance.transform[13] = -1.0f + 2.0f * j / (n - 1);
+            instance.color[0] = float(i) / (n - 1);
+            instance.color[1] = float(j) / (n - 1);
+            triangles.addInstance(instance);
+        }
 }
 
 
@@ -17,8 +35,22 @@ void YawGLViewer::draw() {
         glVertex2d(1,0);
         
     glEnd();*/
+
+    instancedShader.use();
+    triangles.drawInstanced();
+    Mesh::unbind();
+    Shader::unbind();
 }
 
+// the QGLViewer "repaint" slot, called on any change of the viewer state
 void YawGLViewer::update() {
+    ImGuiGLFWApp::postRedraw();
+}
 
+void YawGLViewer::writeCameraBlock(UniformBuffer& uniforms) {
+    CameraBlock block;
+    camera()->getModelViewMatrix(block.modelView.m);
+    camera()->getProjectionMatrix(block.projection.m);
+    camera()->getModelViewProjectionMatrix(block.modelViewProjection.m);
+    uniforms.write(block).bind(CameraBlock::binding);
 }
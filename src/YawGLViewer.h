@@ -3,6 +3,18 @@
 
 #include "trackball/qglviewer.h"
 #include "imgui.h"
+#include "opengl/uniform_buffer.h"
+#include "opengl/shader.h"
+#include "opengl/mesh.h"
+
+// per frame camera matrices, "Camera" uniform block of the 3D shaders
+struct CameraBlock {
+  static const GLuint binding = 0;
+  std140::mat4 modelView;
+  std140::mat4 projection;
+  std140::mat4 modelViewProjection;
+  void write(Std140Writer& w) const { w.write(modelView).write(projection).write(modelViewProjection); }
+};
 
 class YawGLViewer : public QGLViewer {
 
@@ -10,7 +22,12 @@ public:
   virtual void draw();
   virtual void update();
   virtual void init();
+  void writeCameraBlock(UniformBuffer& uniforms);
 
+private:
+  // grid of triangles drawn in a single instanced draw call
+  Shader instancedShader;
+  Mesh triangles;
 };
 
 #endif
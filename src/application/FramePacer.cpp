@@ -0,0 +1,103 @@
+#include "FramePacer.h"
+#include "imgui.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <thread>
+
+// frames kept for the statistics
+static const int statsWindow = 240;
+// at most this many fixed updates per frame, the simulation slows down beyond
+static const int maxSteps = 8;
+// the OS sleep is not precise, the end of the wait is spent spinning
+static const std::chrono::microseconds spinMargin(2000);
+
+FramePacer::FramePacer() :
+    mode_(VSync), targetFPS_(60.0), timestep_(1.0 / 60.0), accumulator_(0.0),
+    started_(false), samples_(statsWindow, 0.0f), next_(0) {
+}
+
+void FramePacer::setRenderMode(RenderMode mode, double targetFPS) {
+    mode_ = mode;
+    targetFPS_ = targetFPS;
+    glfwSwapInterval(mode_ == VSync ? 1 : 0);
+}
+
+int FramePacer::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (!started_) {
+        started_ = true;
+        frameStart_ = now;
+        return 1;
+    }
+
+    std::chrono::duration<double> elapsed = now - frameStart_;
+    frameStart_ = now;
+    addSample(elapsed.count() * 1000.0);
+
+    accumulator_ += elapsed.count();
+    int steps = int(accumulator_ / timestep_);
+    accumulator_ -= steps * timestep_;
+    if (steps > maxSteps) {
+        // we can't keep up (or were stopped in a debugger): drop the late steps
+        steps = maxSteps;
+        accumulator_ = 0.0;
+    }
+    return steps;
+}
+
+void FramePacer::endFrame() {
+    if (mode_ != TargetFPS || targetFPS_ <= 0.0)
+        return;
+
+    Clock::time_point deadline = frameStart_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFPS_));
+    if (deadline - Clock::now() > spinMargin)
+        std::this_thread::sleep_for(deadline - Clock::now() - spinMargin);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::resume() {
+    frameStart_ = Clock::now();
+    accumulator_ = 0.0;
+}
+
+void FramePacer::addSample(double ms) {
+    samples_[next_] = float(ms);
+    next_ = (next_ + 1) % statsWindow;
+    stats_.frames = std::min(stats_.frames + 1, statsWindow);
+    stats_.last = ms;
+
+    std::vector<float> sorted(samples_.begin(), samples_.begin() + stats_.frames);
+    double sum = 0.0;
+    stats_.min = sorted[0];
+    for (float sample : sorted) {
+        sum += sample;
+        stats_.min = std::min(stats_.min, double(sample));
+    }
+    stats_.avg = sum / stats_.frames;
+    int p99 = std::min(int(stats_.frames * 0.99), stats_.frames - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+    stats_.p99 = sorted[p99];
+}
+
+void FramePacer::overlay() {
+    ImGui::Begin("Frame pacing");
+
+    ImGui::Text("frame: %.2f ms (%.0f fps)", stats_.last, stats_.avg > 0.0 ? 1000.0 / stats_.avg : 0.0);
+    ImGui::Text("min %.2f  avg %.2f  p99 %.2f ms", stats_.min, stats_.avg, stats_.p99);
+    ImGui::PlotLines("##frametimes", samples_.data(), stats_.frames, stats_.frames < statsWindow ? 0 : next_, nullptr, 0.0f, float(stats_.p99 * 1.5), ImVec2(0, 60));
+
+    int mode = mode_;
+    bool changed = ImGui::Combo("render", &mode, "uncapped\0vsync\0target fps\0");
+    float fps = float(targetFPS_);
+    if (mode == TargetFPS)
+        changed |= ImGui::SliderFloat("target fps", &fps, 10.0f, 240.0f, "%.0f");
+    if (changed)
+        setRenderMode(RenderMode(mode), fps);
+
+    float rate = float(1.0 / timestep_);
+    if (ImGui::SliderFloat("update rate", &rate, 10.0f, 240.0f, "%.0f Hz"))
+        setUpdateRate(rate);
+
+    ImGui::End();
+}
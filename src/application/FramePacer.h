@@ -0,0 +1,66 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <vector>
+
+// Paces the application loop.
+//
+// The simulation advances by fixed timesteps: beginFrame() adds the elapsed
+// time to an accumulator and returns how many steps to run, alpha() being the
+// fraction of a step left in it, to interpolate the rendered state between the
+// last two steps. Rendering is uncapped, synchronized on vsync, or limited to a
+// target rate by endFrame(), which sleeps then spins until the frame deadline.
+class FramePacer {
+
+public :
+    enum RenderMode { Uncapped, VSync, TargetFPS };
+
+    struct Stats {
+        double last = 0.0;  // milliseconds
+        double min = 0.0;
+        double avg = 0.0;
+        double p99 = 0.0;
+        int frames = 0;     // frames in the statistics window
+    };
+
+    FramePacer();
+
+    // sets the swap interval, the GL context must be current
+    void setRenderMode(RenderMode mode, double targetFPS = 60.0);
+    RenderMode renderMode() const { return mode_; };
+    double targetFPS() const { return targetFPS_; };
+
+    void setUpdateRate(double hz) { timestep_ = 1.0 / hz; };
+    double timestep() const { return timestep_; };
+    double alpha() const { return accumulator_ / timestep_; };
+
+    // returns the number of fixed updates to run this frame
+    int beginFrame();
+    // waits for the frame deadline in TargetFPS mode
+    void endFrame();
+    // the loop slept: the time spent waiting is neither simulated nor measured
+    void resume();
+
+    const Stats& stats() const { return stats_; };
+    // ImGui window with the statistics and the mode selection
+    void overlay();
+
+private :
+    typedef std::chrono::steady_clock Clock;
+
+    void addSample(double ms);
+
+    RenderMode mode_;
+    double targetFPS_;
+    double timestep_;
+    double accumulator_;
+    Clock::time_point frameStart_;
+    bool started_;
+
+    std::vector<float> samples_;    // ring of the last frame times, in ms
+    int next_;
+    Stats stats_;
+};
+
+#endif
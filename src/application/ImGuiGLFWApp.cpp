@@ -1,10 +1,15 @@
 #include "ImGuiGLFWApp.h"
 #include "utils/format.h"
+#include <algorithm>
 #include <iostream>
 
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
+std::atomic<bool> ImGuiGLFWApp::eventReceived_(false);
+std::atomic<bool> ImGuiGLFWApp::redrawPosted_(false);
+std::atomic<bool> ImGuiGLFWApp::waiting_(false);
+
 void ImGuiGLFWApp::glfwErrorCallback(int error, const char* description)
 {
     std::cerr << std::format("GLFW Error {0}: {1]", error, description) << std::endl;
@@ -43,7 +48,7 @@ bool ImGuiGLFWApp::build(const std::string& appName, unsigned int width, unsigne
     if (mainWindow == nullptr)
         return false;
     glfwMakeContextCurrent(mainWindow);
-    glfwSwapInterval(1); // Enable vsync
+    pacer_.setRenderMode(FramePacer::VSync); // Enable vsync
 
 	if (glewInit() != GLEW_OK)
 	{
@@ -53,6 +58,8 @@ bool ImGuiGLFWApp::build(const std::string& appName, unsigned int width, unsigne
     
     updateViewPort();
 
+    uniforms_.create(64 * 1024);
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     io = &ImGui::GetIO(); (void)io;
@@ -73,6 +80,8 @@ bool ImGuiGLFWApp::build(const std::string& appName, unsigned int width, unsigne
     }*/
 
     // Setup Platform/Renderer backends
+    // (our callbacks are installed first, the ImGui backend chains them)
+    installEventCallbacks(mainWindow);
     ImGui_ImplGlfw_InitForOpenGL(mainWindow, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
@@ -86,6 +95,7 @@ void ImGuiGLFWApp::newFrame() {
 }
 void ImGuiGLFWApp::shutdown() {
 	// Cleanup
+	uniforms_.destroy();
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -111,20 +121,64 @@ void ImGuiGLFWApp::endFrame() {
 
 void ImGuiGLFWApp::updateViewPort() {
     // if resize
-    int display_w, display_h;
-    glfwGetFramebufferSize(mainWindow, &display_w, &display_h);
-    glViewport(0, 0, display_w, display_h);    
+    glfwGetFramebufferSize(mainWindow, &displayWidth_, &displayHeight_);
+    glViewport(0, 0, displayWidth_, displayHeight_);    
+
+}
 
+// any input or window event only flags that something happened
+void ImGuiGLFWApp::installEventCallbacks(GLFWwindow* window) {
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { eventReceived_ = true; });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { eventReceived_ = true; });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { eventReceived_ = true; });
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { eventReceived_ = true; });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { eventReceived_ = true; });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { eventReceived_ = true; });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { eventReceived_ = true; });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { eventReceived_ = true; });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { eventReceived_ = true; });
 }
 
-void ImGuiGLFWApp::events() {
+void ImGuiGLFWApp::postRedraw() {
+    redrawPosted_ = true;
+    if (waiting_)
+        glfwPostEmptyEvent();
+}
+
+// returns true when a frame has to be rendered
+bool ImGuiGLFWApp::events() {
     
     // Poll and handle events (inputs, window resize, etc.)
     // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
     // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
     // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
     // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-    glfwPollEvents();
+    // a timer only needs the frame in which it is due, its timeout
+    // may then ask for more
+    double timeout = nextTimeout();
+    bool busy = !idleMode_ || pendingFrames_ > 0 || timeout == 0.0 || animating();
+
+    // waiting_ is raised before redrawPosted_ is checked, and postRedraw()
+    // does the opposite: a redraw posted meanwhile either prevents the wait
+    // or interrupts it with an empty event
+    waiting_ = true;
+    if (busy || redrawPosted_)
+        glfwPollEvents();
+    else {
+        glfwWaitEventsTimeout(timeout > 0.0 ? std::min(timeout, idleTimeout_) : idleTimeout_);
+        pacer_.resume();
+    }
+    waiting_ = false;
+
+    // ImGui needs a few frames after an event to update hover states and layout
+    if (eventReceived_.exchange(false) | redrawPosted_.exchange(false))
+        pendingFrames_ = 3;
+
+    if (pendingFrames_ > 0) {
+        pendingFrames_--;
+        return true;
+    }
+    return busy;
 }
 
 bool ImGuiGLFWApp::closed() {
@@ -135,17 +189,32 @@ void ImGuiGLFWApp::start() {
     
     while (!closed())
     {
-        events();
+        if (!events())
+            continue;
+
+        for (int steps = pacer_.beginFrame(); steps > 0; --steps)
+            fixedUpdate(pacer_.timestep());
 
         newFrame();
   
         clear();        
 
         ui();
+        if (pacingOverlay_)
+            pacer_.overlay();
+
+        uniforms_.beginFrame();
         update();
+        uniforms_.upload();
+
+        renderQueue_.reset(displayWidth_, displayHeight_);
         draw();
+        renderQueue_.execute();
+        uniforms_.endFrame();
         
         endFrame();
+
+        pacer_.endFrame();
     }
 }
 
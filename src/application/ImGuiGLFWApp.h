@@ -4,7 +4,11 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "imgui.h"
+#include "opengl/uniform_buffer.h"
+#include "opengl/render_queue.h"
+#include "FramePacer.h"
 #include <string>
+#include <atomic>
 
 class ImGuiGLFWApp {
 
@@ -15,19 +19,42 @@ public :
     unsigned int width() const { return width_; };
     unsigned int height() const { return height_; };
 
+    // when idle, the loop sleeps until an input event, a posted redraw, the
+    // next timeout of the application or the idle timeout, instead of
+    // rendering at the vsync rate
+    void setIdleMode(bool enabled, double timeout = 1.0) { idleMode_ = enabled; idleTimeout_ = timeout; };
+    // asks for a new frame, wakes the loop up if it sleeps; may be called from any thread
+    static void postRedraw();
+
+    FramePacer& pacer() { return pacer_; };
+    void setPacingOverlay(bool shown) { pacingOverlay_ = shown; };
+
 protected:
     virtual void ui() {};
     virtual void draw() {};
     virtual void update() {};
+    // simulation step, called pacer().timestep() apart; update() may then
+    // interpolate the state with pacer().alpha()
+    virtual void fixedUpdate(double dt) {};
     virtual bool init() { return true; };
+    // true while something has to be rendered every frame
+    virtual bool animating() { return false; };
+    // seconds until a frame is needed without any event (the next timer), 0
+    // when it is due, negative when nothing is scheduled
+    virtual double nextTimeout() { return -1.0; };
+    // per-frame uniform blocks: written in update(), uploaded once before draw()
+    UniformBuffer& uniforms() { return uniforms_; };
+    // draws submitted in draw(), executed in state order once it returns
+    RenderQueue& renderQueue() { return renderQueue_; };
 
 private : 
     static void glfwErrorCallback(int error, const char* description);
+    static void installEventCallbacks(GLFWwindow* window);
     void updateViewPort();
     void newFrame();
     void endFrame();
     void clear();
-    void events();
+    bool events();
     bool closed();
 
 private :
@@ -35,7 +62,21 @@ private :
     ImVec4 clear_color;    
     unsigned int height_;
     unsigned int width_;
+    int displayWidth_;
+    int displayHeight_;
     ImGuiIO* io;
+    UniformBuffer uniforms_;
+    RenderQueue renderQueue_;
+    FramePacer pacer_;
+    bool pacingOverlay_ = false;
+
+    bool idleMode_ = true;
+    double idleTimeout_ = 1.0;
+    // frames still to render after the last event, for ImGui to settle
+    int pendingFrames_ = 3;
+    static std::atomic<bool> eventReceived_;
+    static std::atomic<bool> redrawPosted_;
+    static std::atomic<bool> waiting_;
 };
 
 
@@ -1,15 +1,42 @@
 #include "ImGuiGLFWWindow.h"
+#include "ImGuiGLFWApp.h"
 #include "imgui.h"
+#include <algorithm>
 #include <iostream>
 
-ImGuiGLFWWindow::ImGuiGLFWWindow(const std::string& name, unsigned int w, unsigned int h) {
-    framebuffer.create(w, h);
+FramebufferPool ImGuiGLFWWindow::framebufferPool;
+
+ImGuiGLFWWindow::ImGuiGLFWWindow(const std::string& name, unsigned int w, unsigned int h, int s) {
     width = w; 
     height = h;
+    stableFrames = 0;
+    samples = s;
+    dirty = true;
+    rendered = 0;
+    skipped = 0;
     windowName = name;
     isInitialized = false;
 }
 
+ImGuiGLFWWindow::~ImGuiGLFWWindow() {
+    for (auto& [signal, tracker] : invalidatingSignals)
+        if (!tracker.expired())
+            signal->disconnect(this);
+    framebufferPool.release(framebuffer);
+}
+
+// a dirty panel needs a frame, even if the application is idle
+void ImGuiGLFWWindow::invalidate() {
+    if (!dirty)
+        ImGuiGLFWApp::postRedraw();
+    dirty = true;
+}
+
+void ImGuiGLFWWindow::invalidateOn(AnySignal& signal) {
+    signal.connectNoArgs([this]() { invalidate(); }, this);
+    invalidatingSignals.emplace_back(&signal, signal.tracker());
+}
+
 bool ImGuiGLFWWindow::ui() {
 
     if (!isInitialized) {
@@ -27,35 +54,54 @@ bool ImGuiGLFWWindow::ui() {
     if (ImGui::IsWindowFocused() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
         colorMultiplier.w = 0.1f;
 
-    width = ImGui::GetContentRegionAvail().x;
-    height = ImGui::GetContentRegionAvail().y;
+    unsigned int w = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    unsigned int h = std::max(ImGui::GetContentRegionAvail().y, 1.0f);
+    stableFrames = (w == width && h == height) ? stableFrames + 1 : 0;
+    if (stableFrames == 0)
+        invalidate();
+    width = w;
+    height = h;
 
-    // we rescale the framebuffer to the actual window size here and reset the glViewport 
-    framebuffer.resize(width, height);
+    // the storage is only reallocated when the size leaves its bucket, or
+    // shrunk once the size has settled
+    Framebuffer* previous = framebuffer.framebuffer;
+    framebufferPool.fit(framebuffer, width, height, samples, stableFrames);
+    if (framebuffer.framebuffer != previous)
+        invalidate();
 
-    ImGui::Image(framebuffer.texture(), 
+    // we only show the corner we render into
+    ImGui::Image(framebuffer.framebuffer->texture(), 
         ImVec2(width, height), 
-        ImVec2(0, 1), 
-        ImVec2(1, 0),colorMultiplier);
+        ImVec2(0, float(height) / framebuffer.height), 
+        ImVec2(float(width) / framebuffer.width, 0),colorMultiplier);
 
     ImGui::End();
 
     return true;
 }
 
-void ImGuiGLFWWindow::draw() {
-
-    // now we can bind our framebuffer
-    framebuffer.bind();
-    
-    glViewport(0, 0, width, height);
+void ImGuiGLFWWindow::draw(RenderQueue& queue) {
 
-    glClearColor(0.0f,0.0f,0.0f,1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);  
+    // our framebuffer is bound, sized and cleared by the queue
+    if (!framebuffer.framebuffer)
+        return;
 
-    // and we render our triangle as before
-    drawGL();
-
-    // and unbind it again 
-    framebuffer.unbind();
+    // a clean panel keeps last frame's texture
+    if (!dirty) {
+        skipped++;
+        return;
+    }
+    dirty = false;
+    rendered++;
+    RenderQueue::Target target = queue.addTarget(*framebuffer.framebuffer, width, height);
+
+    // and we submit our triangle as before
+    drawGL(queue, target);
+
+    // a draw waiting for its program leaves the texture incomplete: we draw
+    // again next frame, until the program is linked
+    if (queue.dropped(target) > 0) {
+        dirty = true;
+        ImGuiGLFWApp::postRedraw();
+    }
 }
\ No newline at end of file
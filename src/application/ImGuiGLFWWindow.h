@@ -1,27 +1,52 @@
 #ifndef IMGUI_GLFW_WINDOW_H
 #define IMGUI_GLFW_WINDOW_H
 
-#include "opengl/framebuffer.h"
+#include "opengl/framebuffer_pool.h"
+#include "opengl/uniform_buffer.h"
+#include "opengl/render_queue.h"
+#include "trackball/Signaler.h"
+#include <vector>
 
 
 class ImGuiGLFWWindow {
 
 public :
-    ImGuiGLFWWindow(const std::string& name, unsigned int w, unsigned int h);
+    ImGuiGLFWWindow(const std::string& name, unsigned int w, unsigned int h, int samples = 1);
+    virtual ~ImGuiGLFWWindow();
     bool ui();
-    void draw();
-    virtual void update() {};
+    void draw(RenderQueue& queue);
+    virtual void update(UniformBuffer& uniforms) {};
+
+    // the panel is only redrawn after a resize or an invalidation, otherwise
+    // ImGui keeps showing the texture of its last draw
+    void invalidate();
+    // invalidates the panel each time the signal is emitted, e.g. a camera frame "modified".
+    // The signal may be destroyed before the panel, its slot then goes with it
+    void invalidateOn(AnySignal& signal);
+    bool isDirty() const { return dirty; };
+    const std::string& name() const { return windowName; };
+    unsigned int renderedFrames() const { return rendered; };
+    unsigned int skippedFrames() const { return skipped; };
 
 protected:
-    virtual void drawGL() {};
+    // submits the panel draws, into its framebuffer target
+    virtual void drawGL(RenderQueue& queue, RenderQueue::Target target) {};
     virtual bool init() { return true; };
 
 private :
-  Framebuffer framebuffer;
+  // panels render in the corner of a bucket sized framebuffer of the pool
+  static FramebufferPool framebufferPool;
+  FramebufferPool::Storage framebuffer;
   unsigned int width;
   unsigned int height;
+  int stableFrames;
+  int samples;
   std::string windowName;
   bool isInitialized;
+  bool dirty;
+  unsigned int rendered;
+  unsigned int skipped;
+  std::vector<std::pair<AnySignal*, std::weak_ptr<const void> > > invalidatingSignals;
 };
 
 
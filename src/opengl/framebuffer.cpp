@@ -1,32 +1,68 @@
-
 #include "framebuffer.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 // here we create our framebuffer and our renderbuffer
 // you can find a more detailed explanation of framebuffer 
 // on the official opengl homepage, see the link above
-void Framebuffer::create(unsigned int w, unsigned int h)
+void Framebuffer::create(unsigned int w, unsigned int h, int samples)
 {	
 	width = w;
 	height = h;
 
+	GLint maxSamples = 1;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+	sampleCount = std::clamp(samples, 1, int(maxSamples));
+	changed = false;
+
 	glGenFramebuffers(1, &fbo);
+	glGenTextures(1, &textureId);
+	glGenRenderbuffers(1, &rbo);
+	msFbo = 0;
+	msColor = 0;
+	if (sampleCount > 1) {
+		glGenFramebuffers(1, &msFbo);
+		glGenRenderbuffers(1, &msColor);
+	}
+
+	allocate();
+}
+
+// here we (re)allocate the storage of the attachments:
+// single sampled, the texture and the depth renderbuffer are attached to fbo,
+// multisampled, msFbo gets a color and the depth renderbuffers and fbo only
+// keeps the texture, the resolve destination
+void Framebuffer::allocate()
+{
 	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-	glGenTextures(1, &textureId);
 	glBindTexture(GL_TEXTURE_2D, textureId);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
 
-	glGenRenderbuffers(1, &rbo);
-	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	if (sampleCount > 1) {
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cerr << "ERROR::FRAMEBUFFER:: Resolve framebuffer is not complete!" << std::endl;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, msColor);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, sampleCount, GL_RGB8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msColor);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, sampleCount, GL_DEPTH24_STENCIL8, width, height);
+	}
+	else {
+		glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	}
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -37,10 +73,24 @@ void Framebuffer::create(unsigned int w, unsigned int h)
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
-// here we bind our framebuffer
+// and we release the GL objects
+void Framebuffer::destroy()
+{
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(1, &textureId);
+	glDeleteRenderbuffers(1, &rbo);
+	if (msFbo) {
+		glDeleteFramebuffers(1, &msFbo);
+		glDeleteRenderbuffers(1, &msColor);
+	}
+	fbo = rbo = textureId = msFbo = msColor = 0;
+}
+
+// here we bind our framebuffer, what is drawn next will need a resolve
 void Framebuffer::bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, sampleCount > 1 ? msFbo : fbo);
+	changed = true;
 }
 
 // here we unbind our framebuffer
@@ -58,19 +108,28 @@ bool Framebuffer::resize(unsigned int w, unsigned int h)
 	width = w;
 	height = h;
 
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
+	allocate();
+	changed = false;
 
-	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+	return true;
+}
+
+// we copy the samples in the texture shown by ImGui, only when something was
+// drawn since the last resolve: idle panels cost nothing
+bool Framebuffer::resolve()
+{
+	if (sampleCount == 1 || !changed)
+		return false;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, msFbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	changed = false;
 
 	return true;
 }
 
 void* Framebuffer::texture() const {
 	return (void*)textureId;
-}
\ No newline at end of file
+}
@@ -10,18 +10,29 @@ class Framebuffer
 {
 public:
 
-	void create(unsigned int width, unsigned int height);
+	// with samples > 1 we render in multisampled renderbuffers, resolved in
+	// the texture by resolve()
+	void create(unsigned int width, unsigned int height, int samples = 1);
+	void destroy();
     void bind();
     void unbind();
     bool resize(unsigned int width, unsigned int height);
+    bool resolve();
 	void* texture() const;
+	int samples() const { return sampleCount; };
 
 private:
+	void allocate();
+
     GLuint fbo;
     GLuint rbo;
     GLuint textureId;
+    GLuint msFbo;
+    GLuint msColor;
  	GLuint width;
     GLuint height;
+    int sampleCount;
+    bool changed;
 };
 
 #endif /* opengl_shader_hpp */
@@ -0,0 +1,73 @@
+#include "framebuffer_pool.h"
+
+// powers of two up to 512, then steps of 256 pixels
+unsigned int FramebufferPool::bucket(unsigned int size)
+{
+	if (size > 512)
+		return (size + 255) / 256 * 256;
+
+	unsigned int bucket = 64;
+	while (bucket < size)
+		bucket *= 2;
+	return bucket;
+}
+
+FramebufferPool::Storage FramebufferPool::acquire(unsigned int width, unsigned int height, int samples)
+{
+	Storage storage;
+	storage.width = bucket(width);
+	storage.height = bucket(height);
+	storage.samples = samples;
+
+	for (Entry& entry : entries_)
+		if (!entry.used && entry.width == storage.width && entry.height == storage.height && entry.samples == samples) {
+			entry.used = true;
+			storage.framebuffer = &entry.framebuffer;
+			return storage;
+		}
+
+	entries_.push_back({Framebuffer(), storage.width, storage.height, samples, true});
+	entries_.back().framebuffer.create(storage.width, storage.height, samples);
+	storage.framebuffer = &entries_.back().framebuffer;
+	allocations_++;
+	return storage;
+}
+
+void FramebufferPool::release(Storage& storage)
+{
+	if (!storage.framebuffer)
+		return;
+
+	// the released entry becomes the most recent one, the oldest free ones go first
+	int free = 0;
+	for (auto it = entries_.begin(); it != entries_.end(); ++it)
+		if (&it->framebuffer == storage.framebuffer) {
+			it->used = false;
+			entries_.splice(entries_.end(), entries_, it);
+			break;
+		}
+	for (const Entry& entry : entries_)
+		free += !entry.used;
+	for (auto it = entries_.begin(); it != entries_.end() && free > maxFree;)
+		if (!it->used) {
+			it->framebuffer.destroy();
+			it = entries_.erase(it);
+			free--;
+		}
+		else
+			++it;
+
+	storage = Storage();
+}
+
+void FramebufferPool::fit(Storage& storage, unsigned int width, unsigned int height, int samples, int stableFrames)
+{
+	bool grow = !storage.fits(width, height, samples);
+	bool shrink = !grow && stableFrames == settleFrames
+		&& (bucket(width) < storage.width || bucket(height) < storage.height);
+
+	if (grow || shrink) {
+		release(storage);
+		storage = acquire(width, height, samples);
+	}
+}
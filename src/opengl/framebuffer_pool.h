@@ -0,0 +1,56 @@
+#ifndef framebuffer_pool_hpp
+#define framebuffer_pool_hpp
+
+#include "framebuffer.h"
+
+#include <list>
+
+// Framebuffers allocated by size buckets and shared between panels.
+//
+// A panel renders into the (0, 0, width, height) corner of a storage rounded
+// up to the bucket size, so resizing a panel only reallocates when its size
+// crosses a bucket boundary. Storage larger than needed is given back once
+// the size has settled, and released storage is kept for the next request of
+// the same bucket.
+class FramebufferPool
+{
+public:
+	// storage handed to a panel
+	struct Storage {
+		Framebuffer* framebuffer = nullptr;
+		unsigned int width = 0;
+		unsigned int height = 0;
+		int samples = 1;
+		bool fits(unsigned int w, unsigned int h, int s) const { return framebuffer && w <= width && h <= height && s == samples; };
+	};
+
+	// frames without resize after which oversized storage is shrunk
+	static const int settleFrames = 30;
+	// released storages kept for reuse
+	static const int maxFree = 4;
+
+	static unsigned int bucket(unsigned int size);
+
+	Storage acquire(unsigned int width, unsigned int height, int samples = 1);
+	void release(Storage& storage);
+
+	// storage for a panel of width x height, stable frames being the number of
+	// frames the panel kept this size
+	void fit(Storage& storage, unsigned int width, unsigned int height, int samples, int stableFrames);
+
+	// number of real allocations so far
+	int allocations() const { return allocations_; };
+
+private:
+	struct Entry {
+		Framebuffer framebuffer;
+		unsigned int width, height;
+		int samples;
+		bool used;
+	};
+
+	std::list<Entry> entries_;
+	int allocations_ = 0;
+};
+
+#endif /* framebuffer_pool_hpp */
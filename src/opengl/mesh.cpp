@@ -0,0 +1,223 @@
+#include "mesh.h"
+#include <algorithm>
+#include <cstddef>
+#include <climits>
+#include <iostream>
+#include <GLFW/glfw3.h>
+
+GLuint Mesh::boundVao_ = 0;
+
+Mesh::Mesh() :
+	vbo_(0), vao_(0), ebo_(0), instanceVbo_(0), indexCount_(0), instanceArrays_(false), capacity_(0), dirtyBegin_(INT_MAX), dirtyEnd_(0) {
+}
+
+// the context is destroyed before the application members at exit, the
+// objects went with it
+Mesh::~Mesh()
+{
+	if (glfwGetCurrentContext())
+		destroy();
+}
+
+void Mesh::create(std::span<const Vertex> vertices, std::span<const unsigned int> indices)
+{
+	destroy();
+	indexCount_ = static_cast<GLsizei>(indices.size());
+
+	glGenVertexArrays(1, &vao_);
+	glGenBuffers(1, &vbo_);
+	glGenBuffers(1, &ebo_);
+	glGenBuffers(1, &instanceVbo_);
+	glBindVertexArray(vao_);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size_bytes(), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size_bytes(), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, color));
+	glEnableVertexAttribArray(1);
+
+	// per instance attributes, a mat4 takes four consecutive locations; the
+	// arrays are enabled by drawInstanced()
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVbo_);
+	for (int column = 0; column < 4; ++column) {
+		glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)(offsetof(Instance, transform) + column * 4 * sizeof(float)));
+		glVertexAttribDivisor(2 + column, 1);
+	}
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)offsetof(Instance, color));
+	glVertexAttribDivisor(6, 1);
+	instanceArrays_ = false;
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	boundVao_ = 0;
+
+	// instances added before create() are sent on the first draw
+	capacity_ = 0;
+	dirtyBegin_ = 0;
+	dirtyEnd_ = instanceCount();
+}
+
+void Mesh::destroy()
+{
+	if (!vao_)
+		return;
+
+	if (boundVao_ == vao_)
+		unbind();
+	glDeleteVertexArrays(1, &vao_);
+	glDeleteBuffers(1, &vbo_);
+	glDeleteBuffers(1, &ebo_);
+	glDeleteBuffers(1, &instanceVbo_);
+	vao_ = vbo_ = ebo_ = instanceVbo_ = 0;
+	capacity_ = 0;
+}
+
+void Mesh::bind() const
+{
+	if (boundVao_ == vao_)
+		return;
+	glBindVertexArray(vao_);
+	boundVao_ = vao_;
+}
+
+void Mesh::unbind()
+{
+	if (boundVao_ == 0)
+		return;
+	glBindVertexArray(0);
+	boundVao_ = 0;
+}
+
+// switches the instance arrays of our vertex array, which must be bound
+void Mesh::enableInstanceArrays(bool enabled) const
+{
+	if (instanceArrays_ == enabled)
+		return;
+	for (GLuint location = 2; location <= 6; ++location) {
+		if (enabled)
+			glEnableVertexAttribArray(location);
+		else
+			glDisableVertexAttribArray(location);
+	}
+	instanceArrays_ = enabled;
+}
+
+// single draw: without their arrays, locations 2 to 6 read the current
+// attribute values, a context state that instanced draws may have left
+// undefined, so they are set for each draw
+void Mesh::draw() const
+{
+	bind();
+	enableInstanceArrays(false);
+	const Instance identity;
+	for (int column = 0; column < 4; ++column)
+		glVertexAttrib4fv(2 + column, identity.transform + 4 * column);
+	glVertexAttrib4fv(6, identity.color);
+	glDrawElements(GL_TRIANGLES, indexCount_, GL_UNSIGNED_INT, 0);
+}
+
+// all the instances in one draw call
+void Mesh::drawInstanced()
+{
+	if (instances_.empty())
+		return;
+
+	upload();
+	bind();
+	enableInstanceArrays(true);
+	glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_INT, 0, instanceCount());
+}
+
+Mesh::InstanceId Mesh::addInstance(const Instance& instance)
+{
+	InstanceId id;
+	if (freeIds_.empty()) {
+		id = static_cast<InstanceId>(slots_.size());
+		slots_.push_back(-1);
+	}
+	else {
+		id = freeIds_.back();
+		freeIds_.pop_back();
+	}
+
+	slots_[id] = instanceCount();
+	ids_.push_back(id);
+	instances_.push_back(instance);
+	markDirty(slots_[id]);
+	return id;
+}
+
+void Mesh::updateInstance(InstanceId id, const Instance& instance)
+{
+	if (id < 0 || id >= static_cast<int>(slots_.size()) || slots_[id] < 0) {
+		std::cerr << "ERROR::MESH:: unknown instance " << id << std::endl;
+		return;
+	}
+	instances_[slots_[id]] = instance;
+	markDirty(slots_[id]);
+}
+
+// the last instance takes the place of the removed one, so that the buffer
+// stays packed and only that slot has to be sent again
+void Mesh::removeInstance(InstanceId id)
+{
+	if (id < 0 || id >= static_cast<int>(slots_.size()) || slots_[id] < 0) {
+		std::cerr << "ERROR::MESH:: unknown instance " << id << std::endl;
+		return;
+	}
+
+	int slot = slots_[id];
+	int last = instanceCount() - 1;
+	if (slot != last) {
+		instances_[slot] = instances_[last];
+		ids_[slot] = ids_[last];
+		slots_[ids_[slot]] = slot;
+		markDirty(slot);
+	}
+	instances_.pop_back();
+	ids_.pop_back();
+	slots_[id] = -1;
+	freeIds_.push_back(id);
+
+	dirtyEnd_ = std::min(dirtyEnd_, instanceCount());
+}
+
+void Mesh::clearInstances()
+{
+	instances_.clear();
+	ids_.clear();
+	slots_.clear();
+	freeIds_.clear();
+	dirtyBegin_ = INT_MAX;
+	dirtyEnd_ = 0;
+}
+
+void Mesh::markDirty(int slot)
+{
+	dirtyBegin_ = std::min(dirtyBegin_, slot);
+	dirtyEnd_ = std::max(dirtyEnd_, slot + 1);
+}
+
+void Mesh::upload()
+{
+	if (!instanceVbo_)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVbo_);
+	if (instanceCount() > capacity_) {
+		// grow geometrically and send everything
+		capacity_ = std::max(std::max(2 * capacity_, instanceCount()), 64);
+		glBufferData(GL_ARRAY_BUFFER, capacity_ * sizeof(Instance), NULL, GL_DYNAMIC_DRAW);
+		dirtyBegin_ = 0;
+		dirtyEnd_ = instanceCount();
+	}
+	if (dirtyBegin_ < dirtyEnd_)
+		glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin_ * sizeof(Instance), (dirtyEnd_ - dirtyBegin_) * sizeof(Instance), instances_.data() + dirtyBegin_);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	dirtyBegin_ = INT_MAX;
+	dirtyEnd_ = 0;
+}
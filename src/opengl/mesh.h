@@ -0,0 +1,86 @@
+#ifndef mesh_hpp
+#define mesh_hpp
+
+#include <GL/glew.h>
+
+#include <span>
+#include <vector>
+
+// Indexed geometry (position + color per vertex) drawn either once with draw()
+// or once per instance with drawInstanced().
+//
+// Instances carry their own transform and color as per instance vertex
+// attributes (locations 2 to 5 for the transform columns, 6 for the color, see
+// instanced-shader), with a divisor of 1. Their arrays are only enabled for
+// drawInstanced(): draw() disables them and reads the identity transform and a
+// white color instead. Instances are edited on the CPU side and only the range
+// of instances modified since the last draw is sent to the GPU.
+//
+// A Mesh owns its GL objects: it is not copyable and releases them when
+// destroyed.
+class Mesh
+{
+public:
+	struct Vertex {
+		float position[3];
+		float color[3];
+	};
+
+	struct Instance {
+		float transform[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};	// column major
+		float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+	};
+
+	// stable handle on an instance, its storage slot moves on removal
+	typedef int InstanceId;
+
+	Mesh();
+	~Mesh();
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+
+	// the spans may point into a mapped file, see MeshFile
+	void create(std::span<const Vertex> vertices, std::span<const unsigned int> indices);
+	void destroy();
+
+	// binds the vertex array, skipped when it is already the bound one
+	void bind() const;
+	static void unbind();
+	GLuint vao() const { return vao_; };
+
+	void draw() const;
+	void drawInstanced();
+
+	InstanceId addInstance(const Instance& instance);
+	void updateInstance(InstanceId id, const Instance& instance);
+	void removeInstance(InstanceId id);
+	void clearInstances();
+	const Instance& instance(InstanceId id) const { return instances_[slots_[id]]; };
+	int instanceCount() const { return static_cast<int>(instances_.size()); };
+
+	// sends the dirty instances, done by drawInstanced()
+	void upload();
+
+private:
+	void markDirty(int slot);
+	void enableInstanceArrays(bool enabled) const;
+
+	GLuint vbo_, vao_, ebo_, instanceVbo_;
+	GLsizei indexCount_;
+	// state of the instance arrays in vao_, switched by the draws
+	mutable bool instanceArrays_;
+
+	std::vector<Instance> instances_;
+	std::vector<InstanceId> ids_;		// slot -> id
+	std::vector<int> slots_;			// id -> slot, -1 when removed
+	std::vector<InstanceId> freeIds_;
+
+	// instance buffer capacity (in instances) and [dirtyBegin_, dirtyEnd_) slots to send
+	int capacity_;
+	int dirtyBegin_, dirtyEnd_;
+
+	// vertex array currently bound with bind(), shared by all the meshes of the context
+	static GLuint boundVao_;
+};
+
+#endif /* mesh_hpp */
@@ -0,0 +1,884 @@
+#include "mesh_file.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace {
+
+//---------------------------------------------------------------------------
+// chunks and threads
+//---------------------------------------------------------------------------
+
+// below this, a chunk is not worth a thread
+const size_t minChunkSize = 1 << 20;
+
+int threadCount(int threads, size_t size)
+{
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return static_cast<int>(std::clamp<size_t>(size / minChunkSize, 1, threads));
+}
+
+// runs work(chunk) for the chunks [0, count), each on its own thread
+template<typename F>
+void parallel(int count, F work)
+{
+	std::vector<std::thread> threads;
+	for (int chunk = 1; chunk < count; ++chunk)
+		threads.emplace_back(work, chunk);
+	work(0);
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+// about equal chunks, each made of whole lines
+std::vector<std::string_view> splitLines(std::string_view text, int count)
+{
+	std::vector<std::string_view> chunks;
+	size_t begin = 0;
+	for (int i = 1; i <= count && begin < text.size(); ++i) {
+		size_t end = i == count ? text.size() : std::max(begin, text.size() / count * i);
+		end = text.find('\n', end);
+		end = end == std::string_view::npos ? text.size() : end + 1;
+		chunks.push_back(text.substr(begin, end - begin));
+		begin = end;
+	}
+	return chunks;
+}
+
+// next line of [p, end), p being moved to the following one
+std::string_view nextLine(const char*& p, const char* end)
+{
+	const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+	if (!eol)
+		eol = end;
+	std::string_view line(p, eol - p);
+	p = eol < end ? eol + 1 : end;
+	return line;
+}
+
+//---------------------------------------------------------------------------
+// text values
+//---------------------------------------------------------------------------
+
+const char* skipSpaces(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		++p;
+	return p;
+}
+
+template<typename T>
+bool parseNumber(const char*& p, const char* end, T& value)
+{
+	p = skipSpaces(p, end);
+	if (p < end && *p == '+')
+		++p;
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc())
+		return false;
+	p = result.ptr;
+	return true;
+}
+
+void reportLine(const char* format, std::string_view line)
+{
+	std::cerr << "ERROR::MESHFILE:: " << format << ": " << line.substr(0, 80) << std::endl;
+}
+
+bool validate(const MeshFile::Data& data)
+{
+	unsigned int maxIndex = 0;
+	for (unsigned int index : data.indices)
+		maxIndex = std::max(maxIndex, index);
+	if (!data.indices.empty() && maxIndex >= data.vertices.size()) {
+		std::cerr << "ERROR::MESHFILE:: index " << maxIndex << " out of " << data.vertices.size() << " vertices" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// appends the fan triangulation of a polygon
+template<typename T>
+void triangulate(const std::vector<T>& polygon, std::vector<T>& indices)
+{
+	for (size_t i = 2; i < polygon.size(); ++i) {
+		indices.push_back(polygon[0]);
+		indices.push_back(polygon[i - 1]);
+		indices.push_back(polygon[i]);
+	}
+}
+
+// chunk results concatenated at offsets given by prefix sums
+template<typename T, typename Chunk>
+std::vector<size_t> offsets(const std::vector<Chunk>& chunks, std::vector<T> Chunk::* member)
+{
+	std::vector<size_t> result(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); ++i)
+		result[i + 1] = result[i] + (chunks[i].*member).size();
+	return result;
+}
+
+//---------------------------------------------------------------------------
+// OBJ
+//---------------------------------------------------------------------------
+
+struct ObjChunk {
+	std::vector<Mesh::Vertex> vertices;
+	// value * 2 + 1 for an index relative to the chunk (negative in the file,
+	// resolved once the chunk offsets are known), value * 2 for an absolute one
+	std::vector<int64_t> indices;
+	bool failed = false;
+};
+
+void parseObj(std::string_view text, ObjChunk& chunk)
+{
+	const char* p = text.data();
+	const char* end = p + text.size();
+	std::vector<int64_t> polygon;
+	while (p < end) {
+		std::string_view line = nextLine(p, end);
+		const char* q = skipSpaces(line.data(), line.data() + line.size());
+		const char* eol = line.data() + line.size();
+		if (eol - q < 2 || (q[1] != ' ' && q[1] != '\t'))
+			continue;
+
+		if (q[0] == 'v') {
+			Mesh::Vertex vertex = {{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+			q += 2;
+			if (!parseNumber(q, eol, vertex.position[0]) || !parseNumber(q, eol, vertex.position[1]) || !parseNumber(q, eol, vertex.position[2])) {
+				reportLine("bad OBJ vertex", line);
+				chunk.failed = true;
+				return;
+			}
+			float color[3];
+			if (parseNumber(q, eol, color[0]) && parseNumber(q, eol, color[1]) && parseNumber(q, eol, color[2]))
+				std::copy(color, color + 3, vertex.color);
+			chunk.vertices.push_back(vertex);
+		}
+		else if (q[0] == 'f') {
+			q += 2;
+			polygon.clear();
+			for (q = skipSpaces(q, eol); q < eol; q = skipSpaces(q, eol)) {
+				long long index = 0;
+				if (!parseNumber(q, eol, index) || index == 0) {
+					reportLine("bad OBJ face", line);
+					chunk.failed = true;
+					return;
+				}
+				polygon.push_back(index > 0 ? (index - 1) * 2 : (static_cast<int64_t>(chunk.vertices.size()) + index) * 2 + 1);
+				// texture and normal indices
+				while (q < eol && *q != ' ' && *q != '\t' && *q != '\r')
+					++q;
+			}
+			if (polygon.size() < 3) {
+				reportLine("bad OBJ face", line);
+				chunk.failed = true;
+				return;
+			}
+			triangulate(polygon, chunk.indices);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// PLY
+//---------------------------------------------------------------------------
+
+enum PlyType { PlyInvalid, PlyInt8, PlyUInt8, PlyInt16, PlyUInt16, PlyInt32, PlyUInt32, PlyFloat32, PlyFloat64 };
+
+PlyType plyType(std::string_view name)
+{
+	if (name == "char" || name == "int8") return PlyInt8;
+	if (name == "uchar" || name == "uint8") return PlyUInt8;
+	if (name == "short" || name == "int16") return PlyInt16;
+	if (name == "ushort" || name == "uint16") return PlyUInt16;
+	if (name == "int" || name == "int32") return PlyInt32;
+	if (name == "uint" || name == "uint32") return PlyUInt32;
+	if (name == "float" || name == "float32") return PlyFloat32;
+	if (name == "double" || name == "float64") return PlyFloat64;
+	return PlyInvalid;
+}
+
+size_t plySize(PlyType type)
+{
+	static const size_t sizes[] = {0, 1, 1, 2, 2, 4, 4, 4, 8};
+	return sizes[type];
+}
+
+// colors stored as integers span their type, floating point ones [0, 1]
+float plyColorScale(PlyType type)
+{
+	switch (type) {
+	case PlyInt8: return 1.0f / 127.0f;
+	case PlyUInt8: return 1.0f / 255.0f;
+	case PlyInt16: return 1.0f / 32767.0f;
+	case PlyUInt16: return 1.0f / 65535.0f;
+	case PlyInt32: return 1.0f / 2147483647.0f;
+	case PlyUInt32: return 1.0f / 4294967295.0f;
+	default: return 1.0f;
+	}
+}
+
+template<typename T>
+T plyLoad(const std::byte* p, bool swap)
+{
+	std::byte bytes[sizeof(T)];
+	std::memcpy(bytes, p, sizeof(T));
+	if (swap)
+		std::reverse(bytes, bytes + sizeof(T));
+	T value;
+	std::memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+double plyValue(const std::byte* p, PlyType type, bool swap)
+{
+	switch (type) {
+	case PlyInt8: return plyLoad<int8_t>(p, swap);
+	case PlyUInt8: return plyLoad<uint8_t>(p, swap);
+	case PlyInt16: return plyLoad<int16_t>(p, swap);
+	case PlyUInt16: return plyLoad<uint16_t>(p, swap);
+	case PlyInt32: return plyLoad<int32_t>(p, swap);
+	case PlyUInt32: return plyLoad<uint32_t>(p, swap);
+	case PlyFloat32: return plyLoad<float>(p, swap);
+	case PlyFloat64: return plyLoad<double>(p, swap);
+	default: return 0.0;
+	}
+}
+
+struct PlyProperty {
+	std::string name;
+	PlyType type = PlyInvalid;
+	PlyType countType = PlyInvalid; // valid for a list
+	bool list() const { return countType != PlyInvalid; };
+};
+
+struct PlyElement {
+	std::string name;
+	size_t count = 0;
+	std::vector<PlyProperty> properties;
+	bool scalar() const { return std::none_of(properties.begin(), properties.end(), [](const PlyProperty& property) { return property.list(); }); };
+};
+
+struct PlyHeader {
+	enum Format { Ascii, Binary } format = Ascii;
+	bool swap = false;
+	std::vector<PlyElement> elements;
+	size_t size = 0; // up to the end of "end_header"
+};
+
+// tokens separated by spaces
+std::vector<std::string_view> words(std::string_view line)
+{
+	std::vector<std::string_view> result;
+	const char* p = line.data();
+	const char* end = p + line.size();
+	for (p = skipSpaces(p, end); p < end; p = skipSpaces(p, end)) {
+		const char* word = p;
+		while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+			++p;
+		result.push_back(std::string_view(word, p - word));
+	}
+	return result;
+}
+
+bool parsePlyHeader(std::string_view text, PlyHeader& header)
+{
+	const char* p = text.data();
+	const char* end = p + text.size();
+	if (words(nextLine(p, end)) != std::vector<std::string_view>{"ply"}) {
+		std::cerr << "ERROR::MESHFILE:: not a PLY file" << std::endl;
+		return false;
+	}
+	while (p < end) {
+		std::string_view line = nextLine(p, end);
+		std::vector<std::string_view> word = words(line);
+		if (word.empty() || word[0] == "comment" || word[0] == "obj_info")
+			continue;
+		if (word[0] == "end_header") {
+			header.size = p - text.data();
+			return true;
+		}
+		if (word[0] == "format" && word.size() >= 2) {
+			if (word[1] == "ascii")
+				header.format = PlyHeader::Ascii;
+			else if (word[1] == "binary_little_endian" || word[1] == "binary_big_endian") {
+				header.format = PlyHeader::Binary;
+				header.swap = (word[1] == "binary_little_endian") != (std::endian::native == std::endian::little);
+			}
+			else {
+				reportLine("unknown PLY format", line);
+				return false;
+			}
+		}
+		else if (word[0] == "element" && word.size() == 3) {
+			PlyElement element;
+			element.name = word[1];
+			const char* count = word[2].data();
+			if (!parseNumber(count, word[2].data() + word[2].size(), element.count)) {
+				reportLine("bad PLY element", line);
+				return false;
+			}
+			header.elements.push_back(element);
+		}
+		else if (word[0] == "property" && !header.elements.empty()) {
+			PlyProperty property;
+			if (word.size() == 5 && word[1] == "list") {
+				property.countType = plyType(word[2]);
+				property.type = plyType(word[3]);
+				property.name = word[4];
+			}
+			else if (word.size() == 3) {
+				property.type = plyType(word[1]);
+				property.name = word[2];
+			}
+			if (property.type == PlyInvalid || (word.size() == 5 && property.countType == PlyInvalid)) {
+				reportLine("bad PLY property", line);
+				return false;
+			}
+			header.elements.back().properties.push_back(property);
+		}
+		else {
+			reportLine("bad PLY header line", line);
+			return false;
+		}
+	}
+	std::cerr << "ERROR::MESHFILE:: PLY header without end_header" << std::endl;
+	return false;
+}
+
+// where the vertex properties go: position, then color, -1 when absent
+struct PlyVertexLayout {
+	int property[6] = {-1, -1, -1, -1, -1, -1};
+	float scale[6] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+
+	explicit PlyVertexLayout(const PlyElement& element)
+	{
+		static const char* names[6][2] = {{"x", "x"}, {"y", "y"}, {"z", "z"}, {"red", "diffuse_red"}, {"green", "diffuse_green"}, {"blue", "diffuse_blue"}};
+		for (int i = 0; i < static_cast<int>(element.properties.size()); ++i)
+			for (int k = 0; k < 6; ++k)
+				if (element.properties[i].name == names[k][0] || element.properties[i].name == names[k][1]) {
+					property[k] = i;
+					if (k >= 3)
+						scale[k] = plyColorScale(element.properties[i].type);
+				}
+	}
+
+	bool valid() const { return property[0] >= 0 && property[1] >= 0 && property[2] >= 0; };
+
+	// values of the properties of a record, in order
+	Mesh::Vertex vertex(const double* values) const
+	{
+		Mesh::Vertex vertex = {{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+		for (int k = 0; k < 3; ++k)
+			vertex.position[k] = static_cast<float>(values[property[k]]);
+		if (property[3] >= 0 && property[4] >= 0 && property[5] >= 0)
+			for (int k = 0; k < 3; ++k)
+				vertex.color[k] = static_cast<float>(values[property[3 + k]]) * scale[3 + k];
+		return vertex;
+	}
+};
+
+int plyFaceList(const PlyElement& element)
+{
+	for (int i = 0; i < static_cast<int>(element.properties.size()); ++i)
+		if (element.properties[i].list() && (element.properties[i].name == "vertex_indices" || element.properties[i].name == "vertex_index"))
+			return i;
+	return -1;
+}
+
+// lines of an element, [p, end) moved past them
+bool plyLines(const char*& p, const char* end, size_t count, std::string_view& lines)
+{
+	const char* begin = p;
+	for (size_t i = 0; i < count; ++i) {
+		if (p >= end) {
+			std::cerr << "ERROR::MESHFILE:: truncated PLY file" << std::endl;
+			return false;
+		}
+		nextLine(p, end);
+	}
+	lines = std::string_view(begin, p - begin);
+	return true;
+}
+
+struct PlyChunk {
+	std::vector<Mesh::Vertex> vertices;
+	std::vector<unsigned int> indices;
+	bool failed = false;
+};
+
+void parsePlyAsciiChunk(std::string_view text, const PlyElement& element, bool faces, PlyChunk& chunk)
+{
+	PlyVertexLayout layout(element);
+	int list = plyFaceList(element);
+	std::vector<double> values(element.properties.size());
+	std::vector<unsigned int> polygon;
+
+	const char* p = text.data();
+	const char* end = p + text.size();
+	while (p < end) {
+		std::string_view line = nextLine(p, end);
+		const char* q = line.data();
+		const char* eol = q + line.size();
+		if (skipSpaces(q, eol) == eol)
+			continue;
+		for (size_t i = 0; i < element.properties.size() && !chunk.failed; ++i) {
+			if (!element.properties[i].list()) {
+				chunk.failed = !parseNumber(q, eol, values[i]);
+				continue;
+			}
+			size_t count = 0;
+			chunk.failed = !parseNumber(q, eol, count);
+			polygon.clear();
+			for (size_t k = 0; k < count && !chunk.failed; ++k) {
+				long long index = 0;
+				chunk.failed = !parseNumber(q, eol, index) || index < 0;
+				polygon.push_back(static_cast<unsigned int>(index));
+			}
+			if (static_cast<int>(i) == list && polygon.size() < 3)
+				chunk.failed = true;
+			if (static_cast<int>(i) == list && !chunk.failed)
+				triangulate(polygon, chunk.indices);
+		}
+		if (chunk.failed) {
+			reportLine(faces ? "bad PLY face" : "bad PLY vertex", line);
+			return;
+		}
+		if (!faces)
+			chunk.vertices.push_back(layout.vertex(values.data()));
+	}
+}
+
+bool parsePlyAscii(const char*& p, const char* end, const PlyElement& element, bool faces, MeshFile::Data& data, int threads)
+{
+	std::string_view lines;
+	if (!plyLines(p, end, element.count, lines))
+		return false;
+
+	std::vector<std::string_view> parts = splitLines(lines, threadCount(threads, lines.size()));
+	std::vector<PlyChunk> chunks(parts.size());
+	parallel(static_cast<int>(parts.size()), [&](int i) {
+		parsePlyAsciiChunk(parts[i], element, faces, chunks[i]);
+	});
+	if (std::any_of(chunks.begin(), chunks.end(), [](const PlyChunk& chunk) { return chunk.failed; }))
+		return false;
+
+	std::vector<size_t> vertexOffsets = offsets(chunks, &PlyChunk::vertices);
+	std::vector<size_t> indexOffsets = offsets(chunks, &PlyChunk::indices);
+	size_t vertexBase = data.vertices.size(), indexBase = data.indices.size();
+	data.vertices.resize(vertexBase + vertexOffsets.back());
+	data.indices.resize(indexBase + indexOffsets.back());
+	parallel(static_cast<int>(chunks.size()), [&](int i) {
+		std::copy(chunks[i].vertices.begin(), chunks[i].vertices.end(), data.vertices.begin() + vertexBase + vertexOffsets[i]);
+		std::copy(chunks[i].indices.begin(), chunks[i].indices.end(), data.indices.begin() + indexBase + indexOffsets[i]);
+	});
+	return true;
+}
+
+// size of the record at p, 0 when it goes past end
+size_t plyRecordSize(const std::byte* p, const std::byte* end, const PlyElement& element, bool swap)
+{
+	size_t size = 0;
+	for (const PlyProperty& property : element.properties) {
+		if (!property.list()) {
+			size += plySize(property.type);
+			continue;
+		}
+		if (p + size + plySize(property.countType) > end)
+			return 0;
+		double count = plyValue(p + size, property.countType, swap);
+		size += plySize(property.countType) + static_cast<size_t>(std::max(count, 0.0)) * plySize(property.type);
+	}
+	return p + size <= end ? size : 0;
+}
+
+// vertex indices of the face record at p, false when malformed
+bool plyBinaryPolygon(const std::byte* p, const PlyElement& element, int list, bool swap, std::vector<unsigned int>& polygon)
+{
+	for (int i = 0; i < list; ++i) {
+		const PlyProperty& property = element.properties[i];
+		p += property.list() ? plySize(property.countType) + static_cast<size_t>(plyValue(p, property.countType, swap)) * plySize(property.type) : plySize(property.type);
+	}
+	const PlyProperty& property = element.properties[list];
+	double count = plyValue(p, property.countType, swap);
+	if (count < 3.0)
+		return false;
+	p += plySize(property.countType);
+	polygon.resize(static_cast<size_t>(count));
+	for (size_t k = 0; k < polygon.size(); ++k) {
+		double index = plyValue(p + k * plySize(property.type), property.type, swap);
+		if (index < 0.0)
+			return false;
+		polygon[k] = static_cast<unsigned int>(index);
+	}
+	return true;
+}
+
+bool parsePlyBinaryVertices(const std::byte*& p, const std::byte* end, const PlyElement& element, bool swap, MeshFile::Data& data, int threads)
+{
+	if (!element.scalar()) {
+		std::cerr << "ERROR::MESHFILE:: PLY vertices with list properties" << std::endl;
+		return false;
+	}
+	std::vector<size_t> offset;
+	size_t stride = 0;
+	for (const PlyProperty& property : element.properties) {
+		offset.push_back(stride);
+		stride += plySize(property.type);
+	}
+	if (static_cast<size_t>(end - p) / std::max<size_t>(stride, 1) < element.count) {
+		std::cerr << "ERROR::MESHFILE:: truncated PLY file" << std::endl;
+		return false;
+	}
+
+	// fixed size records, each thread writes its range in place
+	PlyVertexLayout layout(element);
+	size_t base = data.vertices.size();
+	data.vertices.resize(base + element.count);
+	int count = threadCount(threads, element.count * stride);
+	const std::byte* records = p;
+	parallel(count, [&](int chunk) {
+		std::vector<double> values(element.properties.size());
+		size_t begin = element.count * chunk / count, last = element.count * (chunk + 1) / count;
+		for (size_t i = begin; i < last; ++i) {
+			const std::byte* record = records + i * stride;
+			for (size_t k = 0; k < values.size(); ++k)
+				values[k] = plyValue(record + offset[k], element.properties[k].type, swap);
+			data.vertices[base + i] = layout.vertex(values.data());
+		}
+	});
+	p += element.count * stride;
+	return true;
+}
+
+bool parsePlyBinaryFaces(const std::byte*& p, const std::byte* end, const PlyElement& element, bool swap, MeshFile::Data& data, int threads)
+{
+	int list = plyFaceList(element);
+	size_t base = data.indices.size();
+	size_t stride = element.count ? plyRecordSize(p, end, element, swap) : 0;
+
+	// faces usually all have the same number of vertices: the records are
+	// then of the size of the first one and parsed in parallel, each thread
+	// checking the list sizes of its records; otherwise they are read one
+	// after the other
+	std::vector<unsigned int> polygon;
+	if (stride && static_cast<size_t>(end - p) / stride >= element.count && plyBinaryPolygon(p, element, list, swap, polygon)) {
+		struct ListSize {
+			size_t offset;
+			PlyType type;
+			double value;
+		};
+		std::vector<ListSize> counts;
+		size_t offset = 0;
+		for (const PlyProperty& property : element.properties) {
+			double count = property.list() ? plyValue(p + offset, property.countType, swap) : 0.0;
+			if (property.list())
+				counts.push_back({offset, property.countType, count});
+			offset += property.list() ? plySize(property.countType) + static_cast<size_t>(count) * plySize(property.type) : plySize(property.type);
+		}
+		size_t perFace = (polygon.size() - 2) * 3;
+		data.indices.resize(base + element.count * perFace);
+
+		std::atomic<bool> uniform(true);
+		int count = threadCount(threads, element.count * stride);
+		const std::byte* records = p;
+		parallel(count, [&](int chunk) {
+			std::vector<unsigned int> polygon;
+			size_t begin = element.count * chunk / count, last = element.count * (chunk + 1) / count;
+			for (size_t i = begin; i < last && uniform; ++i) {
+				const std::byte* record = records + i * stride;
+				for (const ListSize& size : counts)
+					if (plyValue(record + size.offset, size.type, swap) != size.value)
+						uniform = false;
+				if (!uniform || !plyBinaryPolygon(record, element, list, swap, polygon)) {
+					uniform = false;
+					break;
+				}
+				unsigned int* indices = data.indices.data() + base + i * perFace;
+				for (size_t k = 2; k < polygon.size(); ++k) {
+					*indices++ = polygon[0];
+					*indices++ = polygon[k - 1];
+					*indices++ = polygon[k];
+				}
+			}
+		});
+		if (uniform) {
+			p += element.count * stride;
+			return true;
+		}
+		data.indices.resize(base);
+	}
+
+	for (size_t i = 0; i < element.count; ++i) {
+		size_t size = plyRecordSize(p, end, element, swap);
+		if (!size) {
+			std::cerr << "ERROR::MESHFILE:: truncated PLY file" << std::endl;
+			return false;
+		}
+		if (!plyBinaryPolygon(p, element, list, swap, polygon)) {
+			std::cerr << "ERROR::MESHFILE:: bad PLY face " << i << std::endl;
+			return false;
+		}
+		triangulate(polygon, data.indices);
+		p += size;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// binary format
+//---------------------------------------------------------------------------
+
+const char meshMagic[8] = {'Y', 'A', 'W', 'M', 'E', 'S', 'H', '\0'};
+const uint32_t meshVersion = 1;
+const uint32_t byteOrderMark = 0x01020304;
+const size_t blockAlignment = 64;
+
+struct MeshHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t vertexSize;
+	uint32_t indexSize;
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	float bounds[6];
+	char reserved[48];
+};
+static_assert(sizeof(MeshHeader) == 128, "the mesh header is 128 bytes");
+
+size_t align(size_t offset)
+{
+	return (offset + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+bool hasExtension(const std::string& filename, const char* extension)
+{
+	std::string actual = std::filesystem::path(filename).extension().string();
+	std::transform(actual.begin(), actual.end(), actual.begin(), [](unsigned char c) { return std::tolower(c); });
+	return actual == extension;
+}
+
+}
+
+bool MeshFile::importObj(std::string_view text, Data& data, int threads)
+{
+	std::vector<std::string_view> parts = splitLines(text, threadCount(threads, text.size()));
+	std::vector<ObjChunk> chunks(parts.size());
+	parallel(static_cast<int>(parts.size()), [&](int i) {
+		parseObj(parts[i], chunks[i]);
+	});
+	if (std::any_of(chunks.begin(), chunks.end(), [](const ObjChunk& chunk) { return chunk.failed; }))
+		return false;
+
+	// relative indices count from the first vertex of their chunk
+	std::vector<size_t> vertexOffsets = offsets(chunks, &ObjChunk::vertices);
+	std::vector<size_t> indexOffsets = offsets(chunks, &ObjChunk::indices);
+	data.vertices.resize(vertexOffsets.back());
+	data.indices.resize(indexOffsets.back());
+	std::atomic<bool> failed(false);
+	parallel(static_cast<int>(chunks.size()), [&](int i) {
+		std::copy(chunks[i].vertices.begin(), chunks[i].vertices.end(), data.vertices.begin() + vertexOffsets[i]);
+		unsigned int* indices = data.indices.data() + indexOffsets[i];
+		for (int64_t index : chunks[i].indices) {
+			int64_t resolved = (index >> 1) + ((index & 1) ? static_cast<int64_t>(vertexOffsets[i]) : 0);
+			if (resolved < 0 || resolved > std::numeric_limits<unsigned int>::max())
+				failed = true;
+			*indices++ = static_cast<unsigned int>(resolved);
+		}
+	});
+	if (failed) {
+		std::cerr << "ERROR::MESHFILE:: OBJ face index before the first vertex" << std::endl;
+		return false;
+	}
+	return validate(data);
+}
+
+bool MeshFile::importPly(std::span<const std::byte> bytes, Data& data, int threads)
+{
+	std::string_view text(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	PlyHeader header;
+	if (!parsePlyHeader(text, header))
+		return false;
+
+	data.vertices.clear();
+	data.indices.clear();
+	const char* p = text.data() + header.size;
+	const char* end = text.data() + text.size();
+	for (const PlyElement& element : header.elements) {
+		bool vertices = element.name == "vertex";
+		bool faces = element.name == "face";
+		if (vertices && !PlyVertexLayout(element).valid()) {
+			std::cerr << "ERROR::MESHFILE:: PLY vertices without x, y and z" << std::endl;
+			return false;
+		}
+		if (faces && plyFaceList(element) < 0) {
+			std::cerr << "ERROR::MESHFILE:: PLY faces without vertex_indices" << std::endl;
+			return false;
+		}
+
+		if (header.format == PlyHeader::Ascii) {
+			std::string_view lines;
+			if (vertices || faces) {
+				if (!parsePlyAscii(p, end, element, faces, data, threads))
+					return false;
+			}
+			else if (!plyLines(p, end, element.count, lines))
+				return false;
+			continue;
+		}
+
+		const std::byte* b = reinterpret_cast<const std::byte*>(p);
+		const std::byte* e = reinterpret_cast<const std::byte*>(end);
+		if (vertices) {
+			if (!parsePlyBinaryVertices(b, e, element, header.swap, data, threads))
+				return false;
+		}
+		else if (faces) {
+			if (!parsePlyBinaryFaces(b, e, element, header.swap, data, threads))
+				return false;
+		}
+		else
+			for (size_t i = 0; i < element.count; ++i) {
+				size_t size = plyRecordSize(b, e, element, header.swap);
+				if (!size) {
+					std::cerr << "ERROR::MESHFILE:: truncated PLY file" << std::endl;
+					return false;
+				}
+				b += size;
+			}
+		p = reinterpret_cast<const char*>(b);
+	}
+	return validate(data);
+}
+
+bool MeshFile::import(const std::string& filename, Data& data, int threads)
+{
+	if (hasExtension(filename, ".ymesh")) {
+		MeshFile file;
+		if (!file.open(filename))
+			return false;
+		data.vertices.assign(file.vertices().begin(), file.vertices().end());
+		data.indices.assign(file.indices().begin(), file.indices().end());
+		return true;
+	}
+
+	FileManager::View view = FileManager::map(filename);
+	if (!view.valid())
+		return false;
+	if (hasExtension(filename, ".obj"))
+		return importObj(view.text(), data, threads);
+	if (hasExtension(filename, ".ply"))
+		return importPly(view.bytes(), data, threads);
+	std::cerr << "ERROR::MESHFILE:: unknown mesh format " << filename << std::endl;
+	return false;
+}
+
+// written aside and renamed, like the program binaries
+bool MeshFile::write(const std::string& filename, std::span<const Mesh::Vertex> vertices, std::span<const unsigned int> indices)
+{
+	MeshHeader header = {};
+	std::copy(meshMagic, meshMagic + 8, header.magic);
+	header.version = meshVersion;
+	header.byteOrder = byteOrderMark;
+	header.vertexSize = sizeof(Mesh::Vertex);
+	header.indexSize = sizeof(unsigned int);
+	header.vertexCount = vertices.size();
+	header.indexCount = indices.size();
+	header.vertexOffset = align(sizeof(MeshHeader));
+	header.indexOffset = align(header.vertexOffset + vertices.size_bytes());
+	for (int k = 0; k < 3; ++k) {
+		header.bounds[k] = vertices.empty() ? 0.0f : std::numeric_limits<float>::max();
+		header.bounds[3 + k] = vertices.empty() ? 0.0f : -std::numeric_limits<float>::max();
+	}
+	for (const Mesh::Vertex& vertex : vertices)
+		for (int k = 0; k < 3; ++k) {
+			header.bounds[k] = std::min(header.bounds[k], vertex.position[k]);
+			header.bounds[3 + k] = std::max(header.bounds[3 + k], vertex.position[k]);
+		}
+
+	std::string temporary = filename + ".tmp";
+	{
+		static const char padding[blockAlignment] = {};
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(padding, header.vertexOffset - sizeof(header));
+		file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size_bytes());
+		file.write(padding, header.indexOffset - header.vertexOffset - vertices.size_bytes());
+		file.write(reinterpret_cast<const char*>(indices.data()), indices.size_bytes());
+		if (!file) {
+			std::cerr << "ERROR::MESHFILE:: cannot write " << temporary << std::endl;
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, filename, error);
+	if (error) {
+		std::cerr << "ERROR::MESHFILE:: cannot write " << filename << ": " << error.message() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool MeshFile::convert(const std::string& source, const std::string& destination, int threads)
+{
+	Data data;
+	return import(source, data, threads) && write(destination, data.vertices, data.indices);
+}
+
+// only the header is read: the blocks are left to the page faults of the upload
+bool MeshFile::open(const std::string& filename)
+{
+	close();
+	FileManager::View view = FileManager::map(filename);
+	if (!view.valid())
+		return false;
+
+	MeshHeader header;
+	std::span<const std::byte> bytes = view.bytes();
+	if (bytes.size() < sizeof(header)) {
+		std::cerr << "ERROR::MESHFILE:: not a mesh file " << filename << std::endl;
+		return false;
+	}
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if (!std::equal(meshMagic, meshMagic + 8, header.magic) || header.version != meshVersion) {
+		std::cerr << "ERROR::MESHFILE:: not a mesh file " << filename << std::endl;
+		return false;
+	}
+	if (header.byteOrder != byteOrderMark || header.vertexSize != sizeof(Mesh::Vertex) || header.indexSize != sizeof(unsigned int)) {
+		std::cerr << "ERROR::MESHFILE:: mesh file " << filename << " written by another platform" << std::endl;
+		return false;
+	}
+	if (header.vertexOffset % blockAlignment || header.indexOffset % blockAlignment
+		|| header.vertexOffset > bytes.size() || header.vertexCount > (bytes.size() - header.vertexOffset) / sizeof(Mesh::Vertex)
+		|| header.indexOffset > bytes.size() || header.indexCount > (bytes.size() - header.indexOffset) / sizeof(unsigned int)) {
+		std::cerr << "ERROR::MESHFILE:: truncated mesh file " << filename << std::endl;
+		return false;
+	}
+
+	view_ = view;
+	vertices_ = std::span<const Mesh::Vertex>(reinterpret_cast<const Mesh::Vertex*>(bytes.data() + header.vertexOffset), header.vertexCount);
+	indices_ = std::span<const unsigned int>(reinterpret_cast<const unsigned int*>(bytes.data() + header.indexOffset), header.indexCount);
+	std::copy(header.bounds, header.bounds + 6, bounds_);
+	return true;
+}
+
+void MeshFile::close()
+{
+	view_ = FileManager::View();
+	vertices_ = {};
+	indices_ = {};
+	std::fill(bounds_, bounds_ + 6, 0.0f);
+}
@@ -0,0 +1,60 @@
+#ifndef mesh_file_hpp
+#define mesh_file_hpp
+
+#include "mesh.h"
+#include "utils/file_manager.h"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Mesh import (OBJ, PLY) and the binary mesh format.
+//
+// The text formats are parsed on all the cores: the file is mapped, cut into
+// chunks at line boundaries (record boundaries for binary PLY) and each chunk
+// is parsed by its own thread, the chunks being concatenated once their sizes
+// are known. Polygons are triangulated as fans. OBJ vertices keep the colors
+// of the "v x y z r g b" extension, PLY vertices their red, green and blue
+// properties, the others are white. Normals and texture coordinates are
+// ignored.
+//
+// write() saves a mesh in the binary format (".ymesh"): a 128 bytes header,
+// then the vertices as Mesh::Vertex and the indices as 32 bits unsigned
+// integers, each block starting on a 64 bytes boundary. open() maps such a
+// file and vertices() and indices() point into the mapping, so that
+// Mesh::create() sends them to the buffers as they are, without parsing nor
+// copying them. The file is in the byte order of the machine that wrote it,
+// open() refuses the others.
+class MeshFile
+{
+public:
+	struct Data {
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<unsigned int> indices;
+	};
+
+	// by extension (.obj, .ply or .ymesh), 0 threads being one per core
+	static bool import(const std::string& filename, Data& data, int threads = 0);
+	static bool importObj(std::string_view text, Data& data, int threads = 0);
+	static bool importPly(std::span<const std::byte> bytes, Data& data, int threads = 0);
+
+	static bool write(const std::string& filename, std::span<const Mesh::Vertex> vertices, std::span<const unsigned int> indices);
+	// imports a text mesh and writes it in the binary format
+	static bool convert(const std::string& source, const std::string& destination, int threads = 0);
+
+	bool open(const std::string& filename);
+	void close();
+	std::span<const Mesh::Vertex> vertices() const { return vertices_; };
+	std::span<const unsigned int> indices() const { return indices_; };
+	// min and max corners of the vertices, computed by write()
+	const float* bounds() const { return bounds_; };
+
+private:
+	FileManager::View view_;
+	std::span<const Mesh::Vertex> vertices_;
+	std::span<const unsigned int> indices_;
+	float bounds_[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+#endif /* mesh_file_hpp */
@@ -0,0 +1,291 @@
+#include "program_cache.h"
+#include "shader.h"
+#include "utils/file_manager.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+const uint32_t binaryMagic = 0x47525059; // "YPRG"
+
+// FNV-1a, stable across runs and platforms unlike std::hash
+uint64_t hash(const std::string& data)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : data) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+std::string glString(GLenum name)
+{
+	const GLubyte* value = glGetString(name);
+	return value ? reinterpret_cast<const char*>(value) : "";
+}
+}
+
+ProgramCache& ProgramCache::instance()
+{
+	static ProgramCache cache;
+	return cache;
+}
+
+// the context is current by the time the first program is requested
+void ProgramCache::setup()
+{
+	if (setup_)
+		return;
+	setup_ = true;
+
+	driver_ = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+
+	// let the driver pick its number of compiler threads
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		parallel_ = true;
+	} else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		parallel_ = true;
+	}
+
+	if (GLEW_ARB_get_program_binary) {
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		binary_ = formats > 0;
+	}
+}
+
+const std::string& ProgramCache::source(const std::string& filename)
+{
+	auto it = files_.find(filename);
+	if (it == files_.end()) {
+		it = files_.emplace(filename, FileManager::read(filename)).first;
+		watcher_.watch(filename);
+	}
+	return it->second;
+}
+
+bool ProgramCache::update()
+{
+	bool changed = false;
+	for (const std::string& filename : watcher_.changes()) {
+		files_[filename] = FileManager::read(filename);
+		changed = true;
+	}
+	if (changed)
+		generation_++;
+
+	bool swapped = false;
+	for (Shader* shader : shaders_)
+		swapped |= shader->reload();
+	return swapped;
+}
+
+void ProgramCache::follow(Shader* shader)
+{
+	if (std::find(shaders_.begin(), shaders_.end(), shader) == shaders_.end())
+		shaders_.push_back(shader);
+}
+
+void ProgramCache::unfollow(Shader* shader)
+{
+	shaders_.erase(std::remove(shaders_.begin(), shaders_.end(), shader), shaders_.end());
+}
+
+ProgramCache::Program* ProgramCache::acquire(const std::string& vertex_code, const std::string& fragment_code)
+{
+	std::string key = vertex_code + '\0' + fragment_code;
+	auto it = programs_.find(key);
+	if (it != programs_.end()) {
+		it->second->users++;
+		return it->second.get();
+	}
+
+	setup();
+	std::unique_ptr<Program> program(new Program);
+	program->id = glCreateProgram();
+	if (binary_) {
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash(driver_ + '\0' + key)));
+		program->path = directory_ + "/" + name;
+		glProgramParameteri(program->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	if (!load(*program))
+		compile(*program, vertex_code, fragment_code);
+
+	Program* result = program.get();
+	result->users = 1;
+	programs_.emplace(std::move(key), std::move(program));
+	return result;
+}
+
+void ProgramCache::release(Program* program, bool obsolete)
+{
+	if (!program || --program->users > 0)
+		return;
+
+	// the driver drops a compilation whose program is deleted
+	if (program->status == Program::Compiling) {
+		glDeleteShader(program->vertex_id);
+		glDeleteShader(program->fragment_id);
+		compiling_--;
+	}
+	glDeleteProgram(program->id);
+	if (obsolete && !program->path.empty()) {
+		std::error_code error;
+		std::filesystem::remove(program->path, error);
+	}
+
+	// only on reloads and at exit, a scan is fine
+	for (auto it = programs_.begin(); it != programs_.end(); ++it)
+		if (it->second.get() == program) {
+			programs_.erase(it);
+			return;
+		}
+}
+
+bool ProgramCache::load(Program& program)
+{
+	std::error_code error;
+	if (program.path.empty() || !std::filesystem::exists(program.path, error))
+		return false;
+	// the binary goes from the mapping to the driver, the cache keeps no copy
+	FileManager::View file = FileManager::map(program.path);
+	std::span<const std::byte> bytes = file.bytes();
+	FileManager::evict(program.path);
+
+	uint32_t header[2] = {0, 0}; // magic, binary format
+	if (bytes.size() <= sizeof(header))
+		return false;
+	std::memcpy(header, bytes.data(), sizeof(header));
+	if (header[0] != binaryMagic)
+		return false;
+
+	glProgramBinary(program.id, header[1], bytes.data() + sizeof(header), static_cast<GLsizei>(bytes.size() - sizeof(header)));
+	int success = 0;
+	glGetProgramiv(program.id, GL_LINK_STATUS, &success);
+	if (!success)
+		return false;
+
+	program.status = Program::Linked;
+	loaded_++;
+	return true;
+}
+
+// the binary is written aside and renamed, a file in the cache is always whole
+void ProgramCache::save(const Program& program)
+{
+	if (program.path.empty())
+		return;
+	int length = 0;
+	glGetProgramiv(program.id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program.id, length, &length, &format, binary.data());
+
+	std::error_code error;
+	std::filesystem::create_directories(directory_, error);
+	std::string temporary = program.path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		uint32_t header[2] = {binaryMagic, format};
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(binary.data(), length);
+		if (!file) {
+			std::cerr << "ERROR::PROGRAMCACHE:: cannot write " << temporary << std::endl;
+			return;
+		}
+	}
+	std::filesystem::rename(temporary, program.path, error);
+}
+
+// with parallel compilation these calls return at once, the status is only
+// queried by poll()
+void ProgramCache::compile(Program& program, const std::string& vertex_code, const std::string& fragment_code)
+{
+	const char* vcode = vertex_code.c_str();
+	program.vertex_id = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(program.vertex_id, 1, &vcode, NULL);
+	glCompileShader(program.vertex_id);
+
+	const char* fcode = fragment_code.c_str();
+	program.fragment_id = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(program.fragment_id, 1, &fcode, NULL);
+	glCompileShader(program.fragment_id);
+
+	glAttachShader(program.id, program.vertex_id);
+	glAttachShader(program.id, program.fragment_id);
+	glLinkProgram(program.id);
+	compiled_++;
+	compiling_++;
+
+	if (!parallel_)
+		poll(program, true);
+}
+
+bool ProgramCache::poll(Program& program, bool wait)
+{
+	if (program.status != Program::Compiling)
+		return true;
+
+	if (parallel_ && !wait) {
+		int completed = 0;
+		glGetProgramiv(program.id, GL_COMPLETION_STATUS_KHR, &completed);
+		if (!completed)
+			return false;
+	}
+
+	bool linked = checkLinkingErr(program);
+	if (!linked)
+		checkCompileErr(program);
+	glDetachShader(program.id, program.vertex_id);
+	glDetachShader(program.id, program.fragment_id);
+	glDeleteShader(program.vertex_id);
+	glDeleteShader(program.fragment_id);
+	program.vertex_id = program.fragment_id = 0;
+	compiling_--;
+
+	program.status = linked ? Program::Linked : Program::Failed;
+	if (linked)
+		save(program);
+	return true;
+}
+
+void ProgramCache::checkCompileErr(const Program& program)
+{
+	int success;
+	char infoLog[1024];
+	glGetShaderiv(program.vertex_id, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(program.vertex_id, 1024, NULL, infoLog);
+		std::cerr << "Error compiling Vertex Shader:\n" << infoLog << std::endl;
+	}
+	glGetShaderiv(program.fragment_id, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(program.fragment_id, 1024, NULL, infoLog);
+		std::cerr << "Error compiling Fragment Shader:\n" << infoLog << std::endl;
+	}
+}
+
+bool ProgramCache::checkLinkingErr(const Program& program)
+{
+	int success;
+	char infoLog[1024];
+	glGetProgramiv(program.id, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(program.id, 1024, NULL, infoLog);
+		std::cerr << "Error Linking Shader Program:\n" << infoLog << std::endl;
+	}
+	return success;
+}
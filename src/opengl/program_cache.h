@@ -0,0 +1,110 @@
+#ifndef program_cache_hpp
+#define program_cache_hpp
+
+#include "utils/file_watcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+
+// Linked programs shared by all the shaders of the context.
+//
+// Shaders with identical sources get the same program, compiled once. With
+// GL_KHR_parallel_shader_compile, compiling and linking return immediately
+// and the driver works on its own threads: a program is polled with
+// GL_COMPLETION_STATUS_KHR until it is linked, so that a shader can be
+// skipped instead of stalling the frame. Without the extension, programs are
+// linked when requested.
+//
+// Linked programs are saved with glGetProgramBinary in directory(), in a file
+// named after a hash of the sources and of the driver (vendor, renderer and
+// version strings). The next run loads them with glProgramBinary, without any
+// compilation; a binary refused by the driver (after a driver update) is
+// compiled again and replaced.
+//
+// The shader files read with source() are watched: update() reads the new
+// contents of the files saved since the last frame and increments
+// generation(), after which the shaders initialized from these files request
+// the programs of their new sources and swap them in once linked, see Shader.
+// update() drives these reloads itself, so that a saved file reaches the
+// shaders that are not drawn.
+//
+// Programs are counted: each acquire() is matched by a release(), and a
+// program no shader uses any more is deleted. The binary of a program replaced
+// after a save is deleted with it.
+class ProgramCache
+{
+public:
+	struct Program {
+		enum Status { Compiling, Linked, Failed };
+		unsigned int id = 0;
+		unsigned int vertex_id = 0, fragment_id = 0; // while compiling
+		Status status = Compiling;
+		std::string path; // binary file, empty when binaries are not supported
+		int users = 0; // acquire() not yet released
+	};
+
+	static ProgramCache& instance();
+
+	// program of these sources, compiled or loaded on first request
+	Program* acquire(const std::string& vertex_code, const std::string& fragment_code);
+	// the last release deletes the program, abandoning its compilation; an
+	// obsolete program (its sources were edited) also loses its binary
+	void release(Program* program, bool obsolete = false);
+	// contents of a shader file, read once and again whenever it is saved
+	const std::string& source(const std::string& filename);
+
+	// called once per frame, reads the shader files saved since the last one
+	// and reloads the shaders following them; true if a shader swapped its
+	// program, which needs a redraw
+	bool update();
+	// shaders initialized from files, added and removed by Shader
+	void follow(Shader* shader);
+	void unfollow(Shader* shader);
+	// true while shader files were saved and not read by update() yet, or
+	// programs are still compiling, i.e. while frames are needed to finish a
+	// reload; no side effect, the application loop asks it to know if it may
+	// sleep
+	bool pending() const { return compiling_ > 0 || watcher_.pending(); };
+	// incremented whenever a watched file changes
+	unsigned int generation() const { return generation_; };
+
+	// true once the program is linked (or failed), finishing it if so; wait
+	// blocks until the driver is done
+	bool poll(Program& program, bool wait);
+
+	void setDirectory(const std::string& directory) { directory_ = directory; };
+	const std::string& directory() const { return directory_; };
+
+	// programs compiled from source and loaded from a binary so far
+	int compiled() const { return compiled_; };
+	int loaded() const { return loaded_; };
+
+private:
+	void setup();
+	bool load(Program& program);
+	void save(const Program& program);
+	void compile(Program& program, const std::string& vertex_code, const std::string& fragment_code);
+	void checkCompileErr(const Program& program);
+	bool checkLinkingErr(const Program& program);
+
+	std::unordered_map<std::string, std::unique_ptr<Program>> programs_; // by sources
+	std::unordered_map<std::string, std::string> files_;
+	std::vector<Shader*> shaders_;
+	FileWatcher watcher_;
+	unsigned int generation_ = 0;
+	int compiling_ = 0;
+	std::string directory_ = ".cache/programs";
+	std::string driver_;
+	bool setup_ = false;
+	bool parallel_ = false;
+	bool binary_ = false;
+	int compiled_ = 0;
+	int loaded_ = 0;
+};
+
+#endif /* program_cache_hpp */
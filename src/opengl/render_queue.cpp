@@ -0,0 +1,114 @@
+#include "render_queue.h"
+#include "framebuffer.h"
+#include "shader.h"
+#include "mesh.h"
+#include <algorithm>
+#include <iostream>
+
+void RenderQueue::reset(int width, int height)
+{
+	targets_.clear();
+	packets_.clear();
+	targets_.push_back({nullptr, width, height, false, {0.0f, 0.0f, 0.0f, 0.0f}, 0});
+}
+
+RenderQueue::Target RenderQueue::addTarget(Framebuffer& framebuffer, int width, int height, float r, float g, float b, float a)
+{
+	if (targets_.size() >= 256) {
+		std::cerr << "ERROR::RENDERQUEUE:: too many render targets!" << std::endl;
+		return defaultTarget;
+	}
+	targets_.push_back({&framebuffer, width, height, true, {r, g, b, a}, 0});
+	return static_cast<Target>(targets_.size() - 1);
+}
+
+bool RenderQueue::submit(Target target, Shader& shader, const Mesh& mesh, float depth, std::function<void()> draw)
+{
+	// programs still compiling in the background are drawn from a later frame
+	if (!shader.ready()) {
+		targets_[target].dropped++;
+		return false;
+	}
+	uint64_t quantizedDepth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF);
+	uint64_t key = (static_cast<uint64_t>(target & 0xFF) << 56)
+		| (static_cast<uint64_t>(shader.id() & 0xFFFF) << 40)
+		| (static_cast<uint64_t>(mesh.vao() & 0xFFFF) << 24)
+		| quantizedDepth;
+	packets_.push_back({key, target, &shader, &mesh, std::move(draw)});
+	return true;
+}
+
+void RenderQueue::bindTarget(TargetState& target)
+{
+	if (target.framebuffer)
+		target.framebuffer->bind();
+	else
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, target.width, target.height);
+
+	if (target.clear) {
+		glClearColor(target.color[0], target.color[1], target.color[2], target.color[3]);
+		glClear(GL_COLOR_BUFFER_BIT);
+		target.clear = false;
+	}
+}
+
+void RenderQueue::execute()
+{
+	stats_ = Stats();
+	stats_.packets = static_cast<int>(packets_.size());
+
+	// what the packets would have cost in submission order
+	const Packet* previous = nullptr;
+	for (const Packet& packet : packets_) {
+		stats_.submittedTargetChanges += !previous || previous->target != packet.target;
+		stats_.submittedProgramChanges += !previous || previous->shader->id() != packet.shader->id();
+		stats_.submittedVaoChanges += !previous || previous->mesh->vao() != packet.mesh->vao();
+		previous = &packet;
+	}
+
+	// sort the keys only, the packets stay in place
+	order_.clear();
+	for (int i = 0; i < static_cast<int>(packets_.size()); ++i)
+		order_.push_back({packets_[i].key, i});
+	std::sort(order_.begin(), order_.end());
+
+	Target target = -1;
+	unsigned int program = 0;
+	GLuint vao = 0;
+	for (const auto& entry : order_) {
+		Packet& packet = packets_[entry.second];
+		if (packet.target != target) {
+			target = packet.target;
+			bindTarget(targets_[target]);
+			stats_.targetChanges++;
+		}
+		if (packet.shader->id() != program) {
+			program = packet.shader->id();
+			packet.shader->use();
+			stats_.programChanges++;
+		}
+		if (packet.mesh->vao() != vao) {
+			vao = packet.mesh->vao();
+			packet.mesh->bind();
+			stats_.vaoChanges++;
+		}
+		packet.draw();
+	}
+
+	// targets without any packet are still cleared
+	for (TargetState& state : targets_)
+		if (state.clear)
+			bindTarget(state);
+
+	// multisampled targets are resolved for ImGui, if they were drawn
+	for (TargetState& state : targets_)
+		if (state.framebuffer)
+			state.framebuffer->resolve();
+
+	Mesh::unbind();
+	Shader::unbind();
+	if (!targets_.empty())
+		bindTarget(targets_[defaultTarget]);
+	packets_.clear();
+}
@@ -0,0 +1,80 @@
+#ifndef render_queue_hpp
+#define render_queue_hpp
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class Framebuffer;
+class Shader;
+class Mesh;
+
+// Draws of a frame, collected from every panel and executed in state order.
+//
+// Each submitted packet gets a 64 bits sort key:
+//
+//	| target (8) | program (16) | vertex array (16) | depth (24) |
+//
+// so that, once sorted, the packets sharing a render target, then a program,
+// then a vertex array are consecutive and each state is only set when it
+// changes. Inside a same state the packets are drawn front to back.
+class RenderQueue
+{
+public:
+	typedef int Target;
+	static const Target defaultTarget = 0;
+
+	// state changes of the last execute(), "submitted" counts them in submission order
+	struct Stats {
+		int packets = 0;
+		int targetChanges = 0, programChanges = 0, vaoChanges = 0;
+		int submittedTargetChanges = 0, submittedProgramChanges = 0, submittedVaoChanges = 0;
+		int changes() const { return targetChanges + programChanges + vaoChanges; };
+		int saved() const { return submittedTargetChanges + submittedProgramChanges + submittedVaoChanges - changes(); };
+	};
+
+	// starts a new frame, the default framebuffer covers width x height
+	void reset(int width, int height);
+
+	// offscreen target, cleared to the given color before its first draw
+	Target addTarget(Framebuffer& framebuffer, int width, int height, float r = 0.0f, float g = 0.0f, float b = 0.0f, float a = 1.0f);
+
+	// draw() is called with the target, the shader program and the mesh vertex array bound;
+	// packets of a shader that is not ready() yet are dropped, false is then returned
+	bool submit(Target target, Shader& shader, const Mesh& mesh, float depth, std::function<void()> draw);
+	// packets of the target dropped since reset(): its content is incomplete
+	// and has to be drawn again in a later frame
+	int dropped(Target target) const { return targets_[target].dropped; };
+
+	void execute();
+
+	const Stats& stats() const { return stats_; };
+
+private:
+	struct TargetState {
+		Framebuffer* framebuffer;
+		int width, height;
+		bool clear;
+		float color[4];
+		int dropped;
+	};
+
+	struct Packet {
+		uint64_t key;
+		Target target;
+		Shader* shader;
+		const Mesh* mesh;
+		std::function<void()> draw;
+	};
+
+	void bindTarget(TargetState& target);
+
+	std::vector<TargetState> targets_;
+	std::vector<Packet> packets_;
+	std::vector<std::pair<uint64_t, int> > order_;
+	Stats stats_;
+};
+
+#endif /* render_queue_hpp */
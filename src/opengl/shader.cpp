@@ -1,130 +1,287 @@
 
 #include "shader.h"
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <iostream>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+unsigned int Shader::boundProgram_ = 0;
+
 Shader::Shader() {
 }
 
+// the context is destroyed before the application members at exit, the
+// programs went with it
+Shader::~Shader() {
+	if (glfwGetCurrentContext())
+		release();
+	else
+		ProgramCache::instance().unfollow(this);
+}
+
+void Shader::release() {
+	ProgramCache& cache = ProgramCache::instance();
+	cache.unfollow(this);
+	if (boundProgram_ == id_)
+		unbind();
+	cache.release(pending_);
+	cache.release(program_);
+	pending_ = program_ = nullptr;
+	id_ = 0;
+}
+
 void Shader::init(const std::string& path, const std::string& vertex_code_file_name, const std::string& fragment_code_file_name) {
-	std::string vertex_code_file_path = path + "/" + vertex_code_file_name + ".vs";
-	std::string fragment_code_file_path = path + "/" + fragment_code_file_name + ".fs";
-	std::string vsCode = loadFile(vertex_code_file_path);
-	std::string fsCode  = loadFile(fragment_code_file_path);
-	init(vsCode, fsCode);
+	ProgramCache& cache = ProgramCache::instance();
+	std::string vertex_file = path + "/" + vertex_code_file_name + ".vs";
+	std::string fragment_file = path + "/" + fragment_code_file_name + ".fs";
+	init(cache.source(vertex_file), cache.source(fragment_file));
+	vertex_file_ = vertex_file;
+	fragment_file_ = fragment_file;
+	cache.follow(this);
 }
 
 void Shader::init(const std::string& vertex_code, const std::string& fragment_code) {
-	vertex_code_ = vertex_code;
-	fragment_code_ = fragment_code;
-	compile();
-	link();
+	ProgramCache& cache = ProgramCache::instance();
+	// acquired first, the same sources keep their program
+	ProgramCache::Program* program = cache.acquire(vertex_code, fragment_code);
+	release();
+	program_ = program;
+	id_ = program_->id;
+	linked_ = false;
+	vertex_file_.clear();
+	fragment_file_.clear();
+	generation_ = cache.generation();
+	blockBindings_.clear();
+	uniforms_.clear();
+	uniformIndex_.clear();
+	handles_.clear();
+	ready();
 }
 
-std::string Shader::loadFile(const std::string& filename) const {
-    std::ifstream file;
-    file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-	std::stringstream file_stream;
-	try {
-		file.open(filename.c_str());
-    	file_stream << file.rdbuf();
-		file.close();
-    }
-    catch (std::ifstream::failure e) {
-        std::cerr << "Error reading Shader File!" << std::endl;
-    }
+// never blocks: the new program is only swapped in once the driver is done
+bool Shader::reload() {
+	ProgramCache& cache = ProgramCache::instance();
+	if (vertex_file_.empty())
+		return false;
 
-	return file_stream.str();
+	if (generation_ != cache.generation()) {
+		generation_ = cache.generation();
+		// identical sources give back the current program, e.g. after an undo;
+		// acquired before the release of a program still compiling, which may
+		// be the same
+		ProgramCache::Program* program = cache.acquire(cache.source(vertex_file_), cache.source(fragment_file_));
+		cache.release(pending_, true);
+		pending_ = nullptr;
+		if (program != program_)
+			pending_ = program;
+		else
+			cache.release(program);
+	}
+
+	if (!pending_ || !cache.poll(*pending_, false))
+		return false;
+	bool swapped = pending_->status == ProgramCache::Program::Linked;
+	if (swapped) {
+		if (boundProgram_ == id_)
+			unbind();
+		cache.release(program_, true);
+		program_ = pending_;
+		id_ = program_->id;
+		linked_ = false;
+		linked();
+		version_++;
+	} else {
+		std::cerr << "Error reloading " << vertex_file_ << ", " << fragment_file_ << ": keeping the previous program" << std::endl;
+		cache.release(pending_, true);
+	}
+	pending_ = nullptr;
+	return swapped;
 }
 
+bool Shader::ready() {
+	reload();
+	if (!linked_ && program_ && ProgramCache::instance().poll(*program_, false))
+		linked();
+	return linked_;
+}
 
-void Shader::compile() {
-	const char* vcode = vertex_code_.c_str();
-	vertex_id_ = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex_id_, 1, &vcode, NULL);
-	glCompileShader(vertex_id_);
+void Shader::wait() {
+	if (linked_ || !program_)
+		return;
+	ProgramCache::instance().poll(*program_, true);
+	linked();
+}
 
-	const char* fcode = fragment_code_.c_str();
-	fragment_id_ = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment_id_, 1, &fcode, NULL);
-	glCompileShader(fragment_id_);
-	checkCompileErr();
+void Shader::linked() {
+	linked_ = true;
+	introspect();
+	for (Handle& handle : handles_) {
+		auto it = uniformIndex_.find(handle.name);
+		handle.location = it != uniformIndex_.end() ? uniforms_[it->second].location : -1;
+	}
+	for (const auto& block : blockBindings_) {
+		unsigned int index = glGetUniformBlockIndex(id_, block.first.c_str());
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(id_, index, block.second);
+	}
+	// plain uniforms belong to the program, the reloaded one gets the values
+	// set so far
+	for (const Handle& handle : handles_) {
+		if (handle.type == 0 || handle.location < 0)
+			continue;
+		if (boundProgram_ != id_) {
+			glUseProgram(id_);
+			boundProgram_ = id_;
+		}
+		apply(handle);
+	}
 }
 
-void Shader::link() {
-	id_ = glCreateProgram();
-	glAttachShader(id_, vertex_id_);
-	glAttachShader(id_, fragment_id_);
-	glLinkProgram(id_);
-	checkLinkingErr();
-	glDeleteShader(vertex_id_);
-	glDeleteShader(fragment_id_);
+// we query the active uniforms once, so that setting a uniform afterwards
+// never goes through glGetUniformLocation
+void Shader::introspect() {
+	uniforms_.clear();
+	uniformIndex_.clear();
+
+	int count = 0, maxLength = 0;
+	glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; ++i) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(id_, i, name.size(), &length, &size, &type, name.data());
+
+		ActiveUniform uniform;
+		uniform.name = std::string(name.data(), length);
+		uniform.location = glGetUniformLocation(id_, uniform.name.c_str());
+		uniform.type = type;
+		uniform.size = size;
+
+		// uniforms in blocks have no location
+		if (uniform.location < 0)
+			continue;
+
+		// arrays are reported as "name[0]", we also register them as "name"
+		std::string::size_type bracket = uniform.name.find('[');
+		if (bracket != std::string::npos)
+			uniformIndex_[uniform.name.substr(0, bracket)] = uniforms_.size();
+		uniformIndex_[uniform.name] = uniforms_.size();
+		uniforms_.push_back(uniform);
+	}
 }
 
 void Shader::use() {
-    glUseProgram(id_);
+	reload();
+	wait();
+	if (boundProgram_ == id_)
+		return;
+	glUseProgram(id_);
+	boundProgram_ = id_;
 }
 
-template<>
-void Shader::setUniform<int>(const std::string& name, int val) {
+void Shader::unbind() {
+	if (boundProgram_ == 0)
+		return;
+	glUseProgram(0);
+	boundProgram_ = 0;
+}
+
+Shader::Uniform Shader::uniform(const std::string& name) {
+	wait();
+	Uniform uniform;
+	auto it = uniformIndex_.find(name);
+	if (it == uniformIndex_.end())
+		return uniform;
+	for (uniform.index = 0; uniform.index < static_cast<int>(handles_.size()); ++uniform.index)
+		if (handles_[uniform.index].name == name)
+			return uniform;
+	handles_.push_back({name, uniforms_[it->second].location});
+	return uniform;
+}
+
+// uniform blocks are fed from a UniformBuffer range bound at the same binding point,
+// the bindings are kept for the programs linked later
+void Shader::bindUniformBlock(const std::string& name, unsigned int binding) {
+	blockBindings_.push_back({name, binding});
+	if (!linked_)
+		return;
+	unsigned int index = glGetUniformBlockIndex(id_, name.c_str());
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(id_, index, binding);
+}
+
+// the value is kept for the programs linked later
+void Shader::set(Uniform uniform, int value) {
 	use();
-	glUniform1i(glGetUniformLocation(id_, name.c_str()), val);
+	if (!uniform.valid())
+		return;
+	Handle& handle = handles_[uniform.index];
+	handle.type = GL_INT;
+	handle.intValue = value;
+	apply(handle);
 }
 
-template<>
-void Shader::setUniform<bool>(const std::string& name, bool val) {
+void Shader::set(Uniform uniform, unsigned int type, const float* values, int count) {
 	use();
-	glUniform1i(glGetUniformLocation(id_, name.c_str()), val);
+	if (!uniform.valid())
+		return;
+	Handle& handle = handles_[uniform.index];
+	handle.type = type;
+	std::copy(values, values + count, handle.floatValues);
+	apply(handle);
+}
+
+void Shader::apply(const Handle& handle) {
+	switch (handle.type) {
+	case GL_INT:
+		glUniform1i(handle.location, handle.intValue);
+		break;
+	case GL_FLOAT:
+		glUniform1f(handle.location, handle.floatValues[0]);
+		break;
+	case GL_FLOAT_VEC2:
+		glUniform2f(handle.location, handle.floatValues[0], handle.floatValues[1]);
+		break;
+	case GL_FLOAT_VEC3:
+		glUniform3f(handle.location, handle.floatValues[0], handle.floatValues[1], handle.floatValues[2]);
+		break;
+	case GL_FLOAT_MAT4:
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, handle.floatValues);
+		break;
+	}
 }
 
 template<>
-void Shader::setUniform<float>(const std::string& name, float val) {
-	use();
-	glUniform1f(glGetUniformLocation(id_, name.c_str()), val);
+void Shader::setUniform<int>(Uniform uniform, int val) {
+	set(uniform, val);
 }
 
 template<>
-void Shader::setUniform<float>(const std::string& name, float val1, float val2) {
-	use();
-	glUniform2f(glGetUniformLocation(id_, name.c_str()), val1, val2);
+void Shader::setUniform<bool>(Uniform uniform, bool val) {
+	set(uniform, static_cast<int>(val));
 }
 
 template<>
-void Shader::setUniform<float>(const std::string& name, float val1, float val2, float val3) {
-	use();
-	glUniform3f(glGetUniformLocation(id_, name.c_str()), val1, val2, val3);
+void Shader::setUniform<float>(Uniform uniform, float val) {
+	set(uniform, GL_FLOAT, &val, 1);
 }
 
 template<>
-void Shader::setUniform<float*>(const std::string& name, float* val) {
-	use();
-	glUniformMatrix4fv(glGetUniformLocation(id_, name.c_str()), 1, GL_FALSE, val);
-}
-
-void Shader::checkCompileErr() {
-    int success;
-    char infoLog[1024];
-    glGetShaderiv(vertex_id_, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex_id_, 1024, NULL, infoLog);
-        std::cerr << "Error compiling Vertex Shader:\n" << infoLog << std::endl;
-    }
-	glGetShaderiv(fragment_id_, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		glGetShaderInfoLog(fragment_id_, 1024, NULL, infoLog);
-		std::cerr << "Error compiling Fragment Shader:\n" << infoLog << std::endl;
-	}
+void Shader::setUniform<float>(Uniform uniform, float val1, float val2) {
+	float values[] = {val1, val2};
+	set(uniform, GL_FLOAT_VEC2, values, 2);
 }
 
-void Shader::checkLinkingErr() {
-	int success;
-	char infoLog[1024];
-	glGetProgramiv(id_, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(id_, 1024, NULL, infoLog);
-		std::cerr << "Error Linking Shader Program:\n" << infoLog << std::endl;
-	}
+template<>
+void Shader::setUniform<float>(Uniform uniform, float val1, float val2, float val3) {
+	float values[] = {val1, val2, val3};
+	set(uniform, GL_FLOAT_VEC3, values, 3);
+}
+
+template<>
+void Shader::setUniform<float*>(Uniform uniform, float* val) {
+	set(uniform, GL_FLOAT_MAT4, val, 16);
 }
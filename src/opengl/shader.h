@@ -1,34 +1,112 @@
 #ifndef shader_hpp
 #define shader_hpp
 
+#include "program_cache.h"
+
 #include <string>
 #include <vector>
+#include <unordered_map>
 
+// A program of the ProgramCache, with its uniform table.
+//
+// init() only requests the program: it may still be compiling in the
+// background afterwards. ready() tells without blocking whether it is linked;
+// use(), uniform() and setUniform() wait for it, and uniform block bindings
+// are recorded until then.
+//
+// A shader initialized from files follows their changes: when ProgramCache
+// sees them saved, the program of the new sources is compiled while the
+// current one keeps being used, and replaces it once linked. The reload is
+// driven by ProgramCache::update(), every frame, whether the shader is drawn
+// or not, and version() tells the owners to redraw. The uniform handles, the
+// last values set with setUniform() and the block bindings carry over to the
+// new program. A program that fails to compile is reported and dropped, the
+// current one stays. A program still compiling when the files are saved again
+// is abandoned.
+//
+// The programs are released to the cache when replaced and on destruction,
+// the shader is therefore not copyable.
 class Shader
 {
 public:
+	// Handle on an active uniform of the program, resolved once with uniform()
+	// and located again when the program is reloaded.
+	struct Uniform {
+		int index = -1;
+		bool valid() const { return index >= 0; }
+	};
+
 	Shader();
-	
+	~Shader();
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
 	void init(const std::string& vertex_code, const std::string& fragment_code);
 	void init(const std::string& path, const std::string& vertex_code_file_name, const std::string& fragment_code_file_name);
 
+	bool ready();
 	void use();
+	static void unbind();
+	unsigned int id() const { return id_; };
+	// incremented whenever a reloaded program replaces the current one
+	unsigned int version() const { return version_; };
+
+	Uniform uniform(const std::string& name);
+	void bindUniformBlock(const std::string& name, unsigned int binding);
 
-	template<typename T> void setUniform(const std::string& name, T val);
-	template<typename T> void setUniform(const std::string& name, T val1, T val2);
-	template<typename T> void setUniform(const std::string& name, T val1, T val2, T val3);
+	template<typename T> void setUniform(Uniform uniform, T val);
+	template<typename T> void setUniform(Uniform uniform, T val1, T val2);
+	template<typename T> void setUniform(Uniform uniform, T val1, T val2, T val3);
 
-private :
-	std::string loadFile(const std::string& filename) const;
+	template<typename T> void setUniform(const std::string& name, T val) { setUniform(uniform(name), val); };
+	template<typename T> void setUniform(const std::string& name, T val1, T val2) { setUniform(uniform(name), val1, val2); };
+	template<typename T> void setUniform(const std::string& name, T val1, T val2, T val3) { setUniform(uniform(name), val1, val2, val3); };
 
 private:
-	void checkCompileErr();
-	void checkLinkingErr();
-	void compile();
-	void link();
-	unsigned int vertex_id_, fragment_id_, id_;
-	std::string vertex_code_;
-	std::string fragment_code_;
+	// Active uniform, as reported by glGetActiveUniform.
+	struct ActiveUniform {
+		std::string name;
+		int location;
+		unsigned int type;
+		int size;
+	};
+
+	// uniform resolved with uniform(), Uniform::index is its position in handles_,
+	// with the last value set, given again to the reloaded programs
+	struct Handle {
+		std::string name;
+		int location;
+		unsigned int type = 0; // GL type of the value, 0 until set
+		int intValue = 0;
+		float floatValues[16];
+	};
+
+	friend class ProgramCache;
+
+	// true if a reloaded program was swapped in
+	bool reload();
+	void release();
+	void wait();
+	void linked();
+	void introspect();
+	void set(Uniform uniform, int value);
+	void set(Uniform uniform, unsigned int type, const float* values, int count);
+	static void apply(const Handle& handle);
+	unsigned int id_ = 0;
+	ProgramCache::Program* program_ = nullptr;
+	bool linked_ = false;
+	unsigned int version_ = 0;
+	// source files and program of the new sources, while it compiles
+	std::string vertex_file_, fragment_file_;
+	unsigned int generation_ = 0;
+	ProgramCache::Program* pending_ = nullptr;
+	std::vector<std::pair<std::string, unsigned int>> blockBindings_;
+	std::vector<ActiveUniform> uniforms_;
+	std::unordered_map<std::string, int> uniformIndex_;
+	std::vector<Handle> handles_;
+
+	// program currently bound with use(), shared by all the shaders of the context
+	static unsigned int boundProgram_;
 };
 
 #endif /* opengl_shader_hpp */
@@ -2,23 +2,44 @@
 #define triangle_hpp
 
 #include "shader.h"
+#include "mesh.h"
+#include "render_queue.h"
+#include "uniform_buffer.h"
 #include <GL/glew.h> 
 
 class Triangle
 {
 public:
+	// per object parameters, "Object" uniform block of simple-shader
+	struct ObjectBlock {
+		static const GLuint binding = 1;
+		std140::vec3 color = {1.0f, 1.0f, 1.0f};
+		float rotation = 0.0f;
+		std140::vec2 translation = {0.0f, 0.0f};
+		void write(Std140Writer& w) const { w.write(color).write(rotation).write(translation); }
+	};
+
 	Triangle();
 	void init();
+	void update(UniformBuffer& uniforms);
 	void draw();
-	template<typename T> void setUniform(const std::string& name, T val) { shader.setUniform(name, val); };
-	template<typename T> void setUniform(const std::string& name, T val1, T val2) { shader.setUniform(name, val1, val2); };
-	template<typename T> void setUniform(const std::string& name, T val1, T val2, T val3) { shader.setUniform(name, val1, val2, val3); };
-private :
-  void create(unsigned int &vbo, unsigned int &vao, unsigned int &ebo);
+	void submit(RenderQueue& queue, RenderQueue::Target target = RenderQueue::defaultTarget);
+	void setColor(float r, float g, float b) { object.color = {r, g, b}; version_++; };
+	void setRotation(float rotation) { object.rotation = rotation; version_++; };
+	void setTranslation(float x, float y) { object.translation = {x, y}; version_++; };
+	// incremented by each change of the object parameters and each reload of
+	// the shader
+	unsigned int version() const { return version_ + shader.version(); };
+
+	// the triangle geometry, shared by every instance drawn with instanced-shader
+	static void create(Mesh& mesh);
 
 private:
 	Shader shader;
-  	GLuint vbo, vao, ebo;
+	Mesh mesh;
+	ObjectBlock object;
+	UniformBuffer::Range objectRange;
+	unsigned int version_ = 0;
 };
 
 #endif /* opengl_shader_hpp */
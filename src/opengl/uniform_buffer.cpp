@@ -0,0 +1,122 @@
+#include "uniform_buffer.h"
+#include <cstring>
+#include <iostream>
+
+Std140Writer& Std140Writer::put(const void* val, std::size_t size, std::size_t alignment) {
+	align(alignment);
+	if (data_)
+		std::memcpy(data_ + offset_, val, size);
+	offset_ += size;
+	return *this;
+}
+
+UniformBuffer::UniformBuffer() :
+	buffer_(0), frameSize_(0), alignment_(256), frames_(0), frame_(0), head_(0), mapped_(nullptr) {
+}
+
+UniformBuffer::~UniformBuffer() {
+	destroy();
+}
+
+// we allocate one region per frame in flight: the CPU writes region n while
+// the GPU may still read regions n-1 and n-2
+void UniformBuffer::create(GLsizeiptr frameSize, int frames)
+{
+	destroy();
+
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment_);
+	frameSize_ = (frameSize + alignment_ - 1) / alignment_ * alignment_;
+	frames_ = frames;
+	frame_ = 0;
+	head_ = 0;
+	fences_.assign(frames_, nullptr);
+
+	glGenBuffers(1, &buffer_);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+	if (GLEW_ARB_buffer_storage) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, frameSize_ * frames_, NULL, flags);
+		mapped_ = static_cast<char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, frameSize_ * frames_, flags));
+	}
+	else {
+		glBufferData(GL_UNIFORM_BUFFER, frameSize_ * frames_, NULL, GL_DYNAMIC_DRAW);
+		staging_.resize(frameSize_);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::destroy()
+{
+	for (GLsync fence : fences_)
+		if (fence)
+			glDeleteSync(fence);
+	fences_.clear();
+
+	if (!buffer_)
+		return;
+
+	if (mapped_) {
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		mapped_ = nullptr;
+	}
+	glDeleteBuffers(1, &buffer_);
+	buffer_ = 0;
+	staging_.clear();
+}
+
+// move to the next region, waiting for the GPU to be done with it
+void UniformBuffer::beginFrame()
+{
+	frame_ = (frame_ + 1) % frames_;
+	head_ = 0;
+
+	GLsync& fence = fences_[frame_];
+	if (fence) {
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
+
+void* UniformBuffer::allocate(GLsizeiptr size, Range& range)
+{
+	if (head_ + size > frameSize_) {
+		std::cerr << "ERROR::UNIFORMBUFFER:: frame region is full!" << std::endl;
+		return nullptr;
+	}
+
+	range.buffer = buffer_;
+	range.offset = regionOffset() + head_;
+	range.size = size;
+	head_ += (size + alignment_ - 1) / alignment_ * alignment_;
+
+	if (mapped_)
+		return mapped_ + range.offset;
+	else
+		return staging_.data() + (range.offset - regionOffset());
+}
+
+// the only transfer of the frame, to be called once all the blocks are written
+void UniformBuffer::upload()
+{
+	if (mapped_ || head_ == 0)
+		return;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+	glBufferSubData(GL_UNIFORM_BUFFER, regionOffset(), head_, staging_.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::endFrame()
+{
+	if (mapped_)
+		fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void UniformBuffer::Range::bind(GLuint binding) const
+{
+	if (size > 0)
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+}
@@ -0,0 +1,128 @@
+#ifndef uniform_buffer_hpp
+#define uniform_buffer_hpp
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+// std140 value types, see the "Standard Uniform Block Layout" of the GL spec
+namespace std140 {
+	struct vec2 { float x, y; };
+	struct vec3 { float x, y, z; };
+	struct vec4 { float x, y, z, w; };
+	// column major, as returned by qglviewer::Camera::getProjectionMatrix()
+	struct mat4 { float m[16]; };
+}
+
+// Writes the members of a uniform block at their std140 offsets.
+// A block is any struct with a write(Std140Writer&) method listing its members
+// in the order of the GLSL declaration:
+//
+//	struct ObjectBlock {
+//		std140::vec3 color;
+//		float rotation;
+//		void write(Std140Writer& w) const { w.write(color).write(rotation); }
+//	};
+//
+// Without destination the writer only computes the offsets, see sizeOf().
+class Std140Writer
+{
+public:
+	Std140Writer(void* data = nullptr) : data_(static_cast<char*>(data)), offset_(0) {}
+
+	Std140Writer& write(float val) { return put(&val, sizeof(float), 4); }
+	Std140Writer& write(int val) { return put(&val, sizeof(int), 4); }
+	Std140Writer& write(bool val) { int i = val; return put(&i, sizeof(int), 4); }
+	Std140Writer& write(const std140::vec2& val) { return put(&val, sizeof(val), 8); }
+	Std140Writer& write(const std140::vec3& val) { return put(&val, sizeof(val), 16); }
+	Std140Writer& write(const std140::vec4& val) { return put(&val, sizeof(val), 16); }
+	Std140Writer& write(const std140::mat4& val) { return put(&val, sizeof(val), 16); }
+
+	// array elements are aligned on vec4 boundaries
+	template<typename T> Std140Writer& write(const T* val, int count) {
+		for (int i = 0; i < count; ++i) {
+			align(16);
+			write(val[i]);
+		}
+		align(16);
+		return *this;
+	}
+
+	// nested structures are aligned on vec4 boundaries
+	template<typename Block> Std140Writer& writeStruct(const Block& block) {
+		align(16);
+		block.write(*this);
+		align(16);
+		return *this;
+	}
+
+	std::size_t size() const { return (offset_ + 15) & ~std::size_t(15); }
+
+	template<typename Block> static std::size_t sizeOf(const Block& block) {
+		Std140Writer writer;
+		block.write(writer);
+		return writer.size();
+	}
+
+private:
+	void align(std::size_t alignment) { offset_ = (offset_ + alignment - 1) & ~(alignment - 1); }
+	Std140Writer& put(const void* val, std::size_t size, std::size_t alignment);
+
+	char* data_;
+	std::size_t offset_;
+};
+
+// Ring of per-frame regions in a single uniform buffer.
+//
+// Blocks are written during the frame update (write() is a plain memory copy
+// into the current region), the whole region is handed to the driver once by
+// upload(), and draws then only bind their range. When ARB_buffer_storage is
+// available the buffer is persistently mapped and fences protect the regions
+// still in use by the GPU, otherwise the region is staged in memory and sent
+// with a single glBufferSubData.
+class UniformBuffer
+{
+public:
+	// a block written in the current frame, bound with glBindBufferRange
+	struct Range {
+		GLuint buffer = 0;
+		GLintptr offset = 0;
+		GLsizeiptr size = 0;
+		void bind(GLuint binding) const;
+	};
+
+	UniformBuffer();
+	~UniformBuffer();
+
+	void create(GLsizeiptr frameSize, int frames = 3);
+	void destroy();
+
+	void beginFrame();
+	template<typename Block> Range write(const Block& block) {
+		Range range;
+		Std140Writer writer(allocate(Std140Writer::sizeOf(block), range));
+		block.write(writer);
+		return range;
+	}
+	void upload();
+	void endFrame();
+
+	bool isPersistent() const { return mapped_ != nullptr; }
+
+private:
+	void* allocate(GLsizeiptr size, Range& range);
+	GLintptr regionOffset() const { return frame_ * frameSize_; }
+
+	GLuint buffer_;
+	GLsizeiptr frameSize_;
+	GLint alignment_;
+	int frames_;
+	int frame_;
+	GLsizeiptr head_;
+	char* mapped_;
+	std::vector<char> staging_;
+	std::vector<GLsync> fences_;
+};
+
+#endif /* uniform_buffer_hpp */
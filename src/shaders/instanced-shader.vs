@@ -0,0 +1,20 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 color;
+layout (location = 2) in mat4 instanceTransform;
+layout (location = 6) in vec4 instanceColor;
+
+out vec4 vertexColor;
+
+layout (std140) uniform Camera {
+	mat4 modelView;
+	mat4 projection;
+	mat4 modelViewProjection;
+};
+
+void main()
+{
+	gl_Position = modelViewProjection * instanceTransform * vec4(position, 1.0);
+	vertexColor = instanceColor * vec4(color, 1.0);
+}
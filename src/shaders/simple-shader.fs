@@ -3,9 +3,14 @@
 out vec4 FragColor;
 
 in vec3 vertexColor;
-uniform vec3 color;
+
+layout (std140) uniform Object {
+	vec3 objectColor;
+	float rotation;
+	vec2 translation;
+};
 
 void main()
 {		
-	FragColor = vec4(color*vertexColor,1.0);
+	FragColor = vec4(objectColor*vertexColor,1.0);
 }
@@ -5,8 +5,11 @@ layout (location = 1) in vec3 color;
 
 out vec3 vertexColor;
 
-uniform float rotation;
-uniform vec2 translation;
+layout (std140) uniform Object {
+	vec3 objectColor;
+	float rotation;
+	vec2 translation;
+};
 
 void main()
 {
@@ -0,0 +1,218 @@
+#include "Metronom.h"
+#include <algorithm>
+
+namespace {
+// 5 levels of 64 slots of 1 ms: deadlines up to 2^30 ms (12 days) are placed
+// directly, further ones are placed at the wheel horizon and moved again.
+const int slotBits = 6;
+const int nbSlots = 1 << slotBits;
+const int64_t slotMask = nbSlots - 1;
+const int nbLevels = 5;
+const int64_t horizon = (int64_t(1) << (slotBits * nbLevels)) - 1;
+}
+
+/* Hierarchical timer wheel (Varghese & Lauck): level 0 has one slot per
+   millisecond tick, each slot of level n spans 64^n ticks. A timer is placed
+   in the level of its distance to the current tick. When the ticks of level n
+   wrap around, the next slot of level n+1 is cascaded, its timers being
+   placed again in the lower levels. Slots are intrusive circular lists. */
+class TimerWheel {
+public:
+    static TimerWheel& instance() {
+        static TimerWheel wheel;
+        return wheel;
+    }
+
+    TimerWheel() : origin_(std::chrono::steady_clock::now()), base_(0), count_(0), processing_(false) {
+        for (int level = 0 ; level < nbLevels ; ++level)
+            for (int slot = 0 ; slot < nbSlots ; ++slot)
+                clear(slots_[level][slot]);
+        clear(due_);
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - origin_).count();
+    }
+
+    void add(Metronom * timer) {
+        const int64_t delta = std::min(std::max(timer->expiry_ - base_, int64_t(0)), horizon);
+        const int64_t tick = base_ + delta;
+        int level = 0;
+        while (delta >> (slotBits * (level + 1)))
+            ++level;
+        link(slots_[level][(tick >> (slotBits * level)) & slotMask], timer);
+        ++count_;
+    }
+
+    void remove(Metronom * timer) {
+        unlink(timer);
+        --count_;
+    }
+
+    bool empty() const { return count_ == 0; }
+
+    /* Earliest expiry of the started timers, -1 if none. The slots are not
+       sorted: all the timers are visited, which is fine once per idle wait. */
+    int64_t nextExpiry() const {
+        int64_t next = -1;
+        for (int level = 0 ; level < nbLevels ; ++level)
+            for (int slot = 0 ; slot < nbSlots ; ++slot) {
+                const MetronomLink & list = slots_[level][slot];
+                for (const MetronomLink * node = list.next ; node != &list ; node = node->next) {
+                    const int64_t expiry = static_cast<const Metronom*>(node)->expiry_;
+                    if (next < 0 || expiry < next)
+                        next = expiry;
+                }
+            }
+        return next;
+    }
+
+    /* Processes the ticks up to now. */
+    void process() {
+        if (processing_)
+            return;
+        const int64_t target = now();
+        if (count_ == 0) {
+            base_ = std::max(base_, target + 1);
+            return;
+        }
+
+        processing_ = true;
+        while (base_ <= target && count_ > 0) {
+            for (int level = 1 ; level < nbLevels ; ++level) {
+                if ((base_ >> (slotBits * (level - 1))) & slotMask)
+                    break;
+                cascade(level);
+            }
+
+            // The due timers leave their slot first: a timeout may stop or
+            // restart any of them.
+            splice(slots_[0][base_ & slotMask], due_);
+            const int64_t tick = base_++;
+            while (due_.next != &due_) {
+                Metronom * timer = static_cast<Metronom*>(due_.next);
+                remove(timer);
+                if (timer->expiry_ > tick) {
+                    // beyond the horizon when it was placed
+                    add(timer);
+                    continue;
+                }
+                if (!timer->singleShot_) {
+                    const int64_t period = std::max(timer->interval_, 1);
+                    timer->expiry_ += period;
+                    if (timer->expiry_ <= target)
+                        timer->expiry_ += period * ((target - timer->expiry_) / period + 1);
+                    add(timer);
+                }
+                timer->timeout.emit();
+            }
+        }
+        base_ = std::max(base_, target + 1);
+        processing_ = false;
+    }
+
+private:
+    static void clear(MetronomLink & list) {
+        list.prev = list.next = &list;
+    }
+
+    static void link(MetronomLink & list, MetronomLink * node) {
+        node->prev = list.prev;
+        node->next = &list;
+        list.prev->next = node;
+        list.prev = node;
+    }
+
+    static void unlink(MetronomLink * node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    /* Moves all the nodes of \p from at the end of \p to. */
+    static void splice(MetronomLink & from, MetronomLink & to) {
+        if (from.next == &from)
+            return;
+        from.next->prev = to.prev;
+        to.prev->next = from.next;
+        from.prev->next = &to;
+        to.prev = from.prev;
+        clear(from);
+    }
+
+    void cascade(int level) {
+        MetronomLink moved;
+        clear(moved);
+        splice(slots_[level][(base_ >> (slotBits * level)) & slotMask], moved);
+        while (moved.next != &moved) {
+            Metronom * timer = static_cast<Metronom*>(moved.next);
+            remove(timer);
+            add(timer);
+        }
+    }
+
+    const std::chrono::steady_clock::time_point origin_;
+    int64_t base_; // next tick to process
+    int count_;    // timers in the slots and in due_
+    bool processing_;
+    MetronomLink slots_[nbLevels][nbSlots];
+    MetronomLink due_;
+};
+
+Metronom::Metronom() : started_(std::chrono::steady_clock::now()) {
+    // the wheel outlives the static timers
+    TimerWheel::instance();
+    addSignal("timeout", timeout);
+}
+
+Metronom::~Metronom() {
+    stop();
+}
+
+void Metronom::singleShot(int ms) {
+    singleShot_ = true;
+    start(ms);
+}
+
+void Metronom::start(int ms) {
+    TimerWheel& wheel = TimerWheel::instance();
+    stop();
+    interval_ = std::max(ms, 0);
+    expiry_ = wheel.now() + std::max(interval_, 1);
+    wheel.add(this);
+}
+
+void Metronom::stop() {
+    if (isActive())
+        TimerWheel::instance().remove(this);
+}
+
+void Metronom::start() {
+    started_ = std::chrono::steady_clock::now();
+}
+
+int64_t Metronom::restart() {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - started_).count();
+    started_ = now;
+    return ms;
+}
+
+int64_t Metronom::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_).count();
+}
+
+void Metronom::processTimers() {
+    TimerWheel::instance().process();
+}
+
+bool Metronom::anyRunning() {
+    return !TimerWheel::instance().empty();
+}
+
+int64_t Metronom::nextTimeout() {
+    TimerWheel& wheel = TimerWheel::instance();
+    if (wheel.empty())
+        return -1;
+    return std::max(wheel.nextExpiry() - wheel.now(), int64_t(0));
+}
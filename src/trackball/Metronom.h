@@ -0,0 +1,75 @@
+#ifndef METRONOM_H
+#define METRONOM_H
+
+#include "Signaler.h"
+#include <chrono>
+#include <cstdint>
+
+class TimerWheel;
+
+/* Links of the intrusive timer lists of the TimerWheel. */
+struct MetronomLink {
+    MetronomLink * prev = nullptr;
+    MetronomLink * next = nullptr;
+};
+
+/* Timer (start(int), singleShot()) and elapsed time measure (start(),
+   restart()), in milliseconds.
+
+   The started timers are stored in a hierarchical timer wheel on
+   std::chrono::steady_clock: starting or stopping a timer is O(1), and so is
+   each millisecond tick processed by processTimers(), whatever the number of
+   timers. Nothing runs on its own: the application loop calls processTimers()
+   once per iteration, which emits the "timeout" of the timers whose deadline
+   has passed. A timeout is therefore late by at most one loop iteration, and
+   a periodic timer that missed several periods (a stalled loop) fires once
+   and keeps its phase.
+
+   nextTimeout() tells the application loop how long it may sleep. Timers are
+   not thread safe: they are started, stopped and processed by the GUI
+   thread. */
+class Metronom : public Signaler, private MetronomLink {
+public:
+    Metronom();
+    // The wheel links into the timer: it is neither copied nor assigned.
+    Metronom(const Metronom &) = delete;
+    Metronom & operator=(const Metronom &) = delete;
+    ~Metronom();
+
+    /* Starts a single shot timer, that times out once in \p ms. */
+    void singleShot(int ms);
+    /* Starts (or restarts) the timer, periodic unless isSingleShot(). */
+    void start(int ms);
+    void stop();
+
+    void setSingleShot(bool b) { singleShot_ = b; }
+    bool isSingleShot() const { return singleShot_; }
+    int interval() const { return interval_; }
+    bool isActive() const { return next != nullptr; }
+
+    /* Elapsed time measure: start() sets the reference time, restart()
+       returns the milliseconds elapsed since then and resets it. */
+    void start();
+    int64_t restart();
+    int64_t elapsed() const;
+
+    /* Emits the timeout of the expired timers. Called by the application loop. */
+    static void processTimers();
+    /* True while a periodic timer is started or a single shot is pending. */
+    static bool anyRunning();
+    /* Milliseconds until the next timeout, 0 if one is due, -1 without any
+       started timer. */
+    static int64_t nextTimeout();
+
+    TypedSignal<> timeout;
+
+private:
+    friend class TimerWheel;
+
+    int64_t expiry_ = 0; // wheel tick of the next timeout
+    int interval_ = 0;
+    bool singleShot_ = false;
+    std::chrono::steady_clock::time_point started_;
+};
+
+#endif
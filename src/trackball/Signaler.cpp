@@ -3,97 +3,40 @@
 
 Signaler::Signaler(std::list<std::string> signalName) {
     for( auto it = signalName.begin() ; it != signalName.end() ; ++it)
-        signals[*it] = std::map<void*, AnySignal*>();
-}
-
-template<typename RetT, typename ... ArgsT>
-bool Signaler::connect(const std::string& signalName, std::function<RetT(ArgsT...)> callback, void * called) {
-    if (exists(signalName)) {
-        signals[signalName][called] = new Signal<RetT, ArgsT...>(callback);
-        return true;
-    }
-    else 
-        return false;
-}
-
-template<typename RetT>
-bool Signaler::connect(const std::string& signalName, std::function<RetT()> callback, void * called) {
-    if (exists(signalName)) {
-        signals[signalName][called] = new NoArgsSignal<RetT>(callback);
-        return true;
-    }
-    else 
-        return false;
-}
-
-template<typename ... ArgsT>
-bool Signaler::connect(const std::string& signalName, std::function<void(ArgsT...)> callback, void * called) {
-    if (exists(signalName)) {
-        signals[signalName][called] = new NoRetSignal<ArgsT...>(callback);
-        return true;
-    }
-    else 
-        return false;
+        addSignal(*it);
 }
 
 bool Signaler::connect(const std::string& signalName, std::function<void()> callback, void * called) {
-    if (exists(signalName)) {
-        signals[signalName][called] = new SimpleSignal(callback);
+    AnySignal* s = find(signalName);
+    if (s) {
+        s->connectNoArgs(callback, called);
         return true;
     }
-    else 
+    else
         return false;
 }
 
 bool Signaler::disconnect(const std::string& signalName, void * called) {
-    
+
     if (exists(signalName, called)) {
-        signals[signalName].erase(called);
+        signals[signalName]->disconnect(called);
         return true;
     }
-    else    
+    else
         return false;
 }
 
-void Signaler::emit(const std::string& signalName) {   
-
-    if (exists(signalName))
-        for(auto cit = signals[signalName].begin() ; cit!=signals[signalName].end() ; ++cit)
-            dynamic_cast<SimpleSignal*>(cit->second)->operator()();
-}
+void Signaler::emit(const std::string& signalName) {
 
-template<typename RetT, typename ... ArgsT>
-std::map<void*, RetT> Signaler::emit_get(const std::string& signalName, ArgsT...args) {
-    
-    std::map<void*, RetT> returnedValues = std::map<void*, RetT>();
-    
-    if (exists(signalName))
-        for(auto cit = signals[signalName].begin() ; cit!=signals[signalName].end() ; ++cit)
-            returnedValues[cit->first] = dynamic_cast<Signal<RetT, ArgsT...>*>(cit->second)->operator()(args...);
-    
-    return returnedValues;
+    if (TypedSignal<>* s = find<>(signalName))
+        s->emit();
 }
 
-template<typename RetT>
-std::map<void*, RetT> Signaler::emit_get(const std::string& signalName) {
-    
-    std::map<void*, RetT> returnedValues = std::map<void*, RetT>();
-    
-    if (exists(signalName))
-        for(auto cit = signals[signalName].begin() ; cit!=signals[signalName].end() ; ++cit)
-            returnedValues[cit->first] = dynamic_cast<NoArgsSignal<RetT>*>(cit->second)->operator()();
-    
-    return returnedValues;
-}
-
-
-
 std::function<void()> Signaler::signal(const std::string& signalName)
 {
-    if (exists(signalName)) {
-        auto lambda = [this, &signalName]() {
-            for(auto cit = signals[signalName].begin() ; cit!=signals[signalName].end() ; ++cit)
-                dynamic_cast<SimpleSignal*>(cit->second)->operator()();
+    if (TypedSignal<>* s = find<>(signalName)) {
+        auto lambda = [s]() {
+            s->emit();
         };
         return lambda;
     }
@@ -102,29 +45,37 @@ std::function<void()> Signaler::signal(const std::string& signalName)
 }
 
 bool Signaler::exists(const std::string& signalName, void * called) {
-    
+
     auto it = signals.find(signalName);
-    
-    if (it == signals.end())
-        return false;
 
-    if (it->second.find(called) == it->second.end())
+    if (it == signals.end())
         return false;
 
-    return true;
+    return it->second->isConnected(called);
 }
 
 bool Signaler::exists(const std::string& signalName) {
-    
+
+    return find(signalName) != nullptr;
+}
+
+AnySignal* Signaler::find(const std::string& signalName) const {
+
     auto it = signals.find(signalName);
-    
+
     if (it == signals.end())
-        return false;
+        return nullptr;
     else
-        return true;
+        return it->second;
 }
 
 void Signaler::addSignal(const std::string& signalName) {
-    if (!exists(signalName))
-        signals[signalName] = std::map<void*, AnySignal*>();
-}
\ No newline at end of file
+    if (!exists(signalName)) {
+        ownedSignals.push_back(std::make_unique<TypedSignal<> >());
+        signals[signalName] = ownedSignals.back().get();
+    }
+}
+
+void Signaler::addSignal(const std::string& signalName, AnySignal& signal) {
+    signals[signalName] = &signal;
+}
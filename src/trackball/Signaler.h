@@ -1,127 +1,236 @@
 #ifndef CALLBACL_CALLER_H
 #define CALLBACL_CALLER_H
 
+#include <algorithm>
 #include <map>
 #include <functional>
 #include <list>
+#include <memory>
+#include <string>
+#include <vector>
 
+/* Base class of all the signals. It only provides what the string-keyed
+   compatibility layer of Signaler needs: a type tag (used instead of RTTI to
+   check a signature) and a few virtual methods, called at connection time only. */
 class AnySignal {
 public:
-    AnySignal() {} ;
+    AnySignal(const void * type) : type_(type) {} ;
     virtual ~AnySignal() {};
-};
-
-template<typename RetT, typename ... ArgsT>
-class Signal : public AnySignal {
-public:
-    
-    Signal(std::function<RetT(ArgsT...)> s)  {
-        signal = s;
-    }
 
-    RetT operator()(ArgsT...args) {
-        return signal(args...);
+    /* Unique tag of the TypedSignal<ArgsT...> signature. */
+    template<typename ... ArgsT>
+    static const void * typeOf() {
+        static const char tag = 0;
+        return &tag;
     }
 
-private:
-    std::function<RetT(ArgsT...)> signal;
-};
+    const void * type() const { return type_; }
 
-template<typename RetT>
-class NoArgsSignal : public AnySignal {
-public:
-    
-    NoArgsSignal(std::function<RetT()> s)  {
-        signal = s;
+    /* Expires when the signal is destroyed: an object connected to a signal
+       that may die first checks it before disconnecting. */
+    std::weak_ptr<const void> tracker() const {
+        if (!alive_)
+            alive_ = std::make_shared<char>(0);
+        return alive_;
     }
 
-    RetT operator()() {
-        return signal();
-    }
+    /* Connects a slot that ignores the signal arguments. */
+    virtual void connectNoArgs(std::function<void()> callback, void * called) = 0;
+    virtual bool disconnect(void * called) = 0;
+    virtual bool isConnected(void * called) const = 0;
 
 private:
-    std::function<RetT()> signal;
+    const void * type_;
+    // created by the first tracker() call, most signals are never tracked
+    mutable std::shared_ptr<const void> alive_;
 };
 
+/* A signal with a fixed signature, declared as a member of the emitting class:
+   \code
+   TypedSignal<bool> axisIsDrawnChanged;
+   ...
+   axisIsDrawnChanged.connect([this](bool b) { ... }, this);
+   axisIsDrawnChanged.emit(true);
+   \endcode
+   Slots are stored contiguously and emit() is a plain loop over them: no
+   lookup, no string and no dynamic_cast. Slots may connect and disconnect
+   (themselves included) while the signal is emitted: a disconnected slot is
+   only marked dead until the outermost emit() returns, and a new slot is
+   only called by the next emit(). */
 template<typename ... ArgsT>
-class NoRetSignal : public AnySignal {
+class TypedSignal : public AnySignal {
 public:
-    
-    NoRetSignal(std::function<void(ArgsT...)> s)  {
-        signal = s;
+    typedef std::function<void(ArgsT...)> Slot;
+
+    TypedSignal() : AnySignal(typeOf<ArgsT...>()) {}
+    // Connections belong to an object: they are not copied with it.
+    TypedSignal(const TypedSignal &) : TypedSignal() {}
+    TypedSignal& operator=(const TypedSignal &) { return *this; }
+
+    /* Connects \p callback. \p called identifies the connection, a previous
+       slot connected with the same \p called is replaced. */
+    void connect(Slot callback, void * called) {
+        if (emitting_ > 0) {
+            // the running slot may be the one replaced: keep it alive
+            disconnect(called);
+            added_.push_back({called, std::move(callback)});
+            return;
+        }
+        for (auto it = slots_.begin() ; it != slots_.end() ; ++it)
+            if (it->called == called) {
+                it->callback = std::move(callback);
+                return;
+            }
+        slots_.push_back({called, std::move(callback)});
     }
 
-    void operator()(ArgsT...args) {
-        signal(args...);
+    void connectNoArgs(std::function<void()> callback, void * called) override {
+        if constexpr (sizeof...(ArgsT) == 0)
+            connect(std::move(callback), called);
+        else
+            connect([callback](ArgsT...) { callback(); }, called);
     }
 
-private:
-    std::function<void(ArgsT...)> signal;
-};
+    bool disconnect(void * called) override {
+        for (auto it = added_.begin() ; it != added_.end() ; ++it)
+            if (it->called == called) {
+                added_.erase(it);
+                return true;
+            }
+        for (auto it = slots_.begin() ; it != slots_.end() ; ++it)
+            if (it->alive && it->called == called) {
+                // never destroy a callback that may be running
+                if (emitting_ > 0)
+                    it->alive = false;
+                else
+                    slots_.erase(it);
+                return true;
+            }
+        return false;
+    }
 
-class SimpleSignal : public AnySignal {
-public:
-    
-    SimpleSignal(std::function<void()> s)  {
-        signal = s;
+    bool isConnected(void * called) const override {
+        for (auto it = slots_.begin() ; it != slots_.end() ; ++it)
+            if (it->alive && it->called == called)
+                return true;
+        for (auto it = added_.begin() ; it != added_.end() ; ++it)
+            if (it->called == called)
+                return true;
+        return false;
+    }
+
+    bool empty() const {
+        for (auto it = slots_.begin() ; it != slots_.end() ; ++it)
+            if (it->alive)
+                return false;
+        return added_.empty();
     }
 
-    void operator()() {
-        signal();
+    void emit(ArgsT...args) const {
+        // slots_ neither grows nor shrinks while emitting, see connect() and
+        // disconnect(): it is cleaned up by the outermost emit()
+        Emitting emitting(*this);
+        const std::size_t n = slots_.size();
+        for (std::size_t i = 0 ; i < n ; ++i)
+            if (slots_[i].alive)
+                slots_[i].callback(args...);
     }
 
+    void operator()(ArgsT...args) const {
+        emit(args...);
+    }
 
 private:
-    std::function<void()> signal;
+    struct Connection {
+        void * called;
+        Slot callback;
+        bool alive = true;
+    };
+
+    /* Counts the nested emit() calls, even when a slot throws. */
+    struct Emitting {
+        const TypedSignal & signal;
+        Emitting(const TypedSignal & s) : signal(s) { ++signal.emitting_; }
+        ~Emitting() {
+            if (--signal.emitting_ > 0)
+                return;
+            std::vector<Connection> & slots = signal.slots_;
+            slots.erase(std::remove_if(slots.begin(), slots.end(), [](const Connection & c) { return !c.alive; }), slots.end());
+            for (Connection & c : signal.added_)
+                slots.push_back(std::move(c));
+            signal.added_.clear();
+        }
+    };
+
+    // emit() is const for the emitters, the bookkeeping of the slots is not
+    mutable std::vector<Connection> slots_;
+    mutable std::vector<Connection> added_; // connected while emitting
+    mutable int emitting_ = 0;
 };
 
+/* Base class of the objects that emit signals.
+
+   The signals themselves are TypedSignal members of the derived classes. The
+   Signaler only keeps a name -> signal registry, so that the historical string
+   API (connect("modified", ...), emit("modified")...) keeps working. This
+   registry is only meant for connections: hot paths should emit the typed
+   members directly. */
 class Signaler { // Notifier ?
 
 public:
 
+    Signaler() {};
+    /* Creates a void() signal owned by the Signaler for each name. */
     Signaler(std::list<std::string> signalsName);
-
-    template<typename RetT, typename ... ArgsT>
-    bool connect(const std::string& signalName, std::function<RetT(ArgsT...)> callback, void * called);
-
-    template<typename RetT>
-    bool connect(const std::string& signalName, std::function<RetT()> callback, void * called);
+    // The registry points into this object: it is never copied.
+    Signaler(const Signaler &) : Signaler() {};
+    Signaler& operator=(const Signaler &) { return *this; }
+    virtual ~Signaler() {};
 
     template<typename ... ArgsT>
-    bool connect(const std::string& signalName, std::function<void(ArgsT...)> callback, void * called);
+    bool connect(const std::string& signalName, std::function<void(ArgsT...)> callback, void * called) {
+        TypedSignal<ArgsT...>* s = find<ArgsT...>(signalName);
+        if (s)
+            s->connect(callback, called);
+        return s != nullptr;
+    }
 
     bool connect(const std::string& signalName, std::function<void()> callback, void * called);
 
     bool disconnect(const std::string& signalName, void * called);
-      
-    template<typename RetT, typename ... ArgsT>
-    std::map<void*, RetT> emit_get(const std::string& signalName, ArgsT...args);
-
-    template<typename RetT>
-    std::map<void*, RetT> emit_get(const std::string& signalName);
 
     void emit(const std::string& signalName);
 
     template<typename ... ArgsT>
     void emit(const std::string& signalName, ArgsT...args){
-        if (exists(signalName))
-            for(auto cit = signals[signalName].begin() ; cit!=signals[signalName].end() ; ++cit)
-                dynamic_cast<NoRetSignal<ArgsT...>*>(cit->second)->operator()(args...);
+        if (TypedSignal<ArgsT...>* s = find<ArgsT...>(signalName))
+            s->emit(args...);
     }
 
     std::function<void()> signal(const std::string& signalName);
 
 protected:
     void addSignal(const std::string& signalName);
+    void addSignal(const std::string& signalName, AnySignal& signal);
 
 private :
 
     bool exists(const std::string& signalName, void * called);
     bool exists(const std::string& signalName);
+    AnySignal* find(const std::string& signalName) const;
+
+    template<typename ... ArgsT>
+    TypedSignal<ArgsT...>* find(const std::string& signalName) const {
+        AnySignal* s = find(signalName);
+        if (s && s->type() == AnySignal::typeOf<ArgsT...>())
+            return static_cast<TypedSignal<ArgsT...>*>(s);
+        return nullptr;
+    }
 
 private:
 
-    std::map<std::string, std::map<void*, AnySignal*> > signals;
+    std::map<std::string, AnySignal*> signals;
+    std::list<std::unique_ptr<AnySignal> > ownedSignals;
 };
 
-#endif
\ No newline at end of file
+#endif
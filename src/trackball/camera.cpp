@@ -17,9 +17,12 @@ using namespace qglviewer;
  focusDistance() documentations for default stereo parameter values. */
 Camera::Camera()
     : frame_(nullptr), fieldOfView_(M_PI / 4.0), modelViewMatrixIsUpToDate_(false),
-      projectionMatrixIsUpToDate_(false) {
+      projectionMatrixIsUpToDate_(false),
+      modelViewProjectionMatrixIsUpToDate_(false),
+      modelViewProjectionVersion_(0) {
   // #CONNECTION# Camera copy constructor
   interpolationKfi_ = new KeyFrameInterpolator;
+  depthQueries_ = new DepthQueries(this);
   // Requires the interpolationKfi_
   setFrame(new ManipulatedCameraFrame());
 
@@ -69,12 +72,16 @@ Camera::Camera()
 Camera::~Camera() {
   delete frame_;
   delete interpolationKfi_;
+  delete depthQueries_;
 }
 
 /*! Copy constructor. Performs a deep copy using operator=(). */
-Camera::Camera(const Camera &camera) : frame_(nullptr) {
+Camera::Camera(const Camera &camera)
+    : frame_(nullptr), modelViewProjectionMatrixIsUpToDate_(false),
+      modelViewProjectionVersion_(0) {
   // #CONNECTION# Camera constructor
   interpolationKfi_ = new KeyFrameInterpolator;
+  depthQueries_ = new DepthQueries(this);
   // Requires the interpolationKfi_
   setFrame(new ManipulatedCameraFrame(*camera.frame()));
 
@@ -280,13 +287,13 @@ void Camera::setFrame(ManipulatedCameraFrame *const mcf) {
     return;
 
   if (frame_) {
-    frame_->disconnect("modified", this);    
+    frame_->modified.disconnect(this);
   }
 
   frame_ = mcf;
   interpolationKfi_->setFrame(frame());
 
-  frame_->connect("modified", std::bind(&Camera::onFrameModified, this), this);    
+  frame_->modified.connect(std::bind(&Camera::onFrameModified, this), this);
   onFrameModified();
 }
 
@@ -378,6 +385,7 @@ void Camera::computeProjectionMatrix() const {
   }
 
   projectionMatrixIsUpToDate_ = true;
+  modelViewProjectionMatrixIsUpToDate_ = false;
 }
 
 /*! Computes the modelView matrix associated with the Camera's position() and
@@ -435,6 +443,7 @@ void Camera::computeModelViewMatrix() const {
   modelViewMatrix_[15] = 1.0;
 
   modelViewMatrixIsUpToDate_ = true;
+  modelViewProjectionMatrixIsUpToDate_ = false;
 }
 
 /*! Loads the OpenGL \c GL_PROJECTION matrix with the Camera projection matrix.
@@ -604,6 +613,7 @@ void Camera::loadModelViewMatrixStereo(bool leftBuffer) const {
     modelViewMatrix_[12] -= shift;
   else
     modelViewMatrix_[12] += shift;
+  modelViewProjectionMatrixIsUpToDate_ = false;
   glLoadMatrixd(modelViewMatrix_);
 }
 
@@ -855,13 +865,17 @@ void Camera::setFOVToFitScene() {
 
  See also interpolateToFitScene(). */
 void Camera::interpolateToZoomOnPixel(const QPoint &pixel) {
-  const qreal coef = 0.1;
-
   bool found;
   Vec target = pointUnderPixel(pixel, found);
 
-  if (!found)
-    return;
+  if (found)
+    interpolateToZoomOnPoint(target);
+}
+
+/*! Same as interpolateToZoomOnPixel(), on a \p target point given in world
+ coordinates, typically the result of an asynchronous pointUnderPixel(). */
+void Camera::interpolateToZoomOnPoint(const Vec &target) {
+  const qreal coef = 0.1;
 
   if (interpolationKfi_->interpolationIsStarted())
     interpolationKfi_->stopInterpolation();
@@ -939,7 +953,9 @@ void Camera::interpolateTo(Frame &fr, qreal duration) {
 /*! Returns the coordinates of the 3D point located at pixel (x,y) on screen.
 
  Calls a \c glReadPixel to get the pixel depth and applies an
- unprojectedCoordinatesOf() to the result. \p found indicates whether a point
+ unprojectedCoordinatesOf() to the result. This read back waits for the GPU to
+ complete the frame: prefer the asynchronous overload, that takes a callback,
+ in interactive code. \p found indicates whether a point
  was found or not (i.e. background pixel, result's depth is zFar() in that
  case).
 
@@ -966,6 +982,20 @@ Vec Camera::pointUnderPixel(const QPoint &pixel, bool &found) const {
   return point;
 }
 
+/*! Asynchronous version of pointUnderPixel().
+
+ The depth of \p pixel is read back without stalling the GPU pipeline:
+ \p callback is called, one or two frames later, with the point and whether it
+ was found. The read back is batched with the other requests of the frame, see
+ DepthQueries. The unprojection uses the matrices the frame was drawn with.
+
+ Requires a QGLViewer to flush and poll depthQueries(). Use
+ depthQueries().finish() to wait for the result instead. */
+void Camera::pointUnderPixel(const QPoint &pixel,
+                             const DepthQueries::Callback &callback) const {
+  depthQueries_->request(pixel, callback);
+}
+
 /*! Moves the Camera so that the entire scene is visible.
 
  Simply calls fitSphere() on a sphere defined by sceneCenter() and
@@ -1472,9 +1502,8 @@ void Camera::getViewport(GLint viewport[4]) const {
  before calling this method. Call computeModelViewMatrix() and
  computeProjectionMatrix() to do so.
 
- If you call this method several times with no change in the matrices, consider
- precomputing the projection times modelview matrix to save computation time if
- required (\c P x \c M in the \c gluProject man page).
+ The projection times model view matrix is cached until the matrices change.
+ Use the array version to project many points at once.
 
  Here is the code corresponding to what this method does (kindly submitted by
  Robert W. Kuhn) : \code Vec project(Vec point)
@@ -1524,19 +1553,9 @@ void Camera::getViewport(GLint viewport[4]) const {
  \endcode
  */
 Vec Camera::projectedCoordinatesOf(const Vec &src, const Frame *frame) const {
-  GLdouble x, y, z;
-  static GLint viewport[4];
-  getViewport(viewport);
-
-  if (frame) {
-    const Vec tmp = frame->inverseCoordinatesOf(src);
-    gluProject(tmp.x, tmp.y, tmp.z, modelViewMatrix_, projectionMatrix_,
-               viewport, &x, &y, &z);
-  } else
-    gluProject(src.x, src.y, src.z, modelViewMatrix_, projectionMatrix_,
-               viewport, &x, &y, &z);
-
-  return Vec(x, y, z);
+  Vec res = frame ? frame->inverseCoordinatesOf(src) : src;
+  projectedCoordinatesOf(&res, &res, 1);
+  return res;
 }
 
 /*! Returns the world unprojected coordinates of a point \p src defined in the
@@ -1567,20 +1586,138 @@ Vec Camera::projectedCoordinatesOf(const Vec &src, const Frame *frame) const {
  before calling this method (use computeModelViewMatrix(),
  computeProjectionMatrix()). See also setScreenWidthAndHeight().
 
- This method is not computationally optimized. If you call it several times with
- no change in the matrices, you should buffer the entire inverse projection
- matrix (modelview, projection and then viewport) to speed-up the queries. See
- the \c gluUnProject man page for details. */
+ The inverse of the projection times model view matrix is cached until the
+ matrices change. Use the array version to unproject many points at once. */
 Vec Camera::unprojectedCoordinatesOf(const Vec &src, const Frame *frame) const {
-  GLdouble x, y, z;
-  static GLint viewport[4];
-  getViewport(viewport);
-  gluUnProject(src.x, src.y, src.z, modelViewMatrix_, projectionMatrix_,
-               viewport, &x, &y, &z);
+  Vec res;
+  unprojectedCoordinatesOf(&src, &res, 1);
   if (frame)
-    return frame->coordinatesOf(Vec(x, y, z));
+    return frame->coordinatesOf(res);
   else
-    return Vec(x, y, z);
+    return res;
+}
+
+/*! Computes the projection times model view matrix and its inverse, used by
+ projectedCoordinatesOf() and unprojectedCoordinatesOf(). They are only updated
+ after computeModelViewMatrix() or computeProjectionMatrix() actually changed
+ the matrices. */
+void Camera::computeModelViewProjectionMatrix() const {
+  if (modelViewProjectionMatrixIsUpToDate_)
+    return;
+
+  GLdouble *const m = modelViewProjectionMatrix_;
+  for (unsigned short i = 0; i < 4; ++i)
+    for (unsigned short j = 0; j < 4; ++j) {
+      qreal sum = 0.0;
+      for (unsigned short k = 0; k < 4; ++k)
+        sum += projectionMatrix_[i + 4 * k] * modelViewMatrix_[k + 4 * j];
+      m[i + 4 * j] = sum;
+    }
+
+  // Cofactors, as in gluUnProject (the matrix is not necessarily affine)
+  GLdouble inv[16];
+  inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] +
+           m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+  inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] -
+           m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+  inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] +
+           m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+  inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] -
+            m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+  inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] -
+           m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+  inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] +
+           m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+  inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] -
+           m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+  inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] +
+            m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+  inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] +
+           m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+  inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] -
+           m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+  inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] +
+            m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+  inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] -
+            m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+  inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] -
+           m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+  inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] +
+           m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+  inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] -
+            m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+  inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] +
+            m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+  const qreal det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+  // A singular matrix (camera not set up yet) unprojects everything to 0
+  const qreal invDet = (det != 0.0) ? 1.0 / det : 0.0;
+  for (unsigned short i = 0; i < 16; ++i)
+    inverseModelViewProjectionMatrix_[i] = inv[i] * invDet;
+
+  modelViewProjectionMatrixIsUpToDate_ = true;
+  ++modelViewProjectionVersion_;
+}
+
+/*! Returns a counter incremented each time the matrices used by
+ projectedCoordinatesOf() and unprojectedCoordinatesOf() change. Screen space
+ caches (see MouseGrabberIndex) compare it, with the screenWidth() and
+ screenHeight(), to know whether they are still valid. */
+unsigned int Camera::modelViewProjectionVersion() const {
+  computeModelViewProjectionMatrix();
+  return modelViewProjectionVersion_;
+}
+
+/*! Same as projectedCoordinatesOf(), for the \p nb world coordinates points of
+ \p src, written in \p res (which can be identical to \p src).
+
+ Uses the cached projection times model view matrix: no matrix is recomputed
+ and the loop has no branch, so that it can be vectorized. */
+void Camera::projectedCoordinatesOf(const Vec src[], Vec res[], int nb) const {
+  computeModelViewProjectionMatrix();
+  const GLdouble *const m = modelViewProjectionMatrix_;
+  // viewport of getViewport(), origin in the upper left corner
+  const qreal w = 0.5 * screenWidth();
+  const qreal h = -0.5 * screenHeight();
+  const qreal oy = screenHeight();
+
+  for (int i = 0; i < nb; ++i) {
+    const qreal x = src[i].x, y = src[i].y, z = src[i].z;
+    const qreal cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    const qreal cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    const qreal cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    const qreal iw = 1.0 / (m[3] * x + m[7] * y + m[11] * z + m[15]);
+    res[i].x = w * (cx * iw + 1.0);
+    res[i].y = oy + h * (cy * iw + 1.0);
+    res[i].z = 0.5 * (cz * iw + 1.0);
+  }
+}
+
+/*! Same as unprojectedCoordinatesOf(), for the \p nb screen coordinates points
+ of \p src, written in world coordinates in \p res (which can be identical to
+ \p src).
+
+ Uses the cached inverse of the projection times model view matrix, instead of
+ inverting it for each point as \c gluUnProject does. */
+void Camera::unprojectedCoordinatesOf(const Vec src[], Vec res[], int nb) const {
+  computeModelViewProjectionMatrix();
+  const GLdouble *const m = inverseModelViewProjectionMatrix_;
+  const qreal sx = 2.0 / screenWidth();
+  const qreal sy = -2.0 / screenHeight();
+
+  for (int i = 0; i < nb; ++i) {
+    // to normalized device coordinates
+    const qreal x = src[i].x * sx - 1.0;
+    const qreal y = (src[i].y - screenHeight()) * sy - 1.0;
+    const qreal z = 2.0 * src[i].z - 1.0;
+    const qreal ox = m[0] * x + m[4] * y + m[8] * z + m[12];
+    const qreal oy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    const qreal oz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    const qreal iw = 1.0 / (m[3] * x + m[7] * y + m[11] * z + m[15]);
+    res[i].x = ox * iw;
+    res[i].y = oy * iw;
+    res[i].z = oz * iw;
+  }
 }
 
 /*! Same as projectedCoordinatesOf(), but with \c qreal parameters (\p src and
@@ -1,6 +1,7 @@
 #ifndef QGLVIEWER_CAMERA_H
 #define QGLVIEWER_CAMERA_H
 
+#include "depthQueries.h"
 #include "keyFrameInterpolator.h"
 #include <map>
 #include <OpenGL/gl.h>
@@ -118,6 +119,7 @@ public:
   void fitScreenRegion(const QRect &rectangle);
   void centerScene();
   void interpolateToZoomOnPixel(const QPoint &pixel);
+  void interpolateToZoomOnPoint(const Vec &target);
   void interpolateToFitScene();
   void interpolateTo(Frame &fr, qreal duration);
   //@}
@@ -385,6 +387,7 @@ public:
 
   void getModelViewProjectionMatrix(GLfloat m[16]) const;
   void getModelViewProjectionMatrix(GLdouble m[16]) const;
+  unsigned int modelViewProjectionVersion() const;
 //@}
 
 /*! @name Drawing */
@@ -410,8 +413,15 @@ public:
                                  const Frame *frame = nullptr) const;
   void getUnprojectedCoordinatesOf(const qreal src[3], qreal res[3],
                                    const Frame *frame = nullptr) const;
+  void projectedCoordinatesOf(const Vec src[], Vec res[], int nb) const;
+  void unprojectedCoordinatesOf(const Vec src[], Vec res[], int nb) const;
   void convertClickToLine(const QPoint &pixel, Vec &orig, Vec &dir) const;
   Vec pointUnderPixel(const QPoint &pixel, bool &found) const;
+  void pointUnderPixel(const QPoint &pixel,
+                       const DepthQueries::Callback &callback) const;
+  /*! Returns the queue of the asynchronous pointUnderPixel() requests. It is
+  flushed and polled by QGLViewer::paintGL(). */
+  DepthQueries &depthQueries() const { return *depthQueries_; }
   //@}
 
   /*! @name Fly speed */
@@ -512,6 +522,12 @@ private:
   mutable bool modelViewMatrixIsUpToDate_;
   mutable GLdouble projectionMatrix_[16]; // Buffered projection matrix.
   mutable bool projectionMatrixIsUpToDate_;
+  // projection times model view and its inverse, for the (un)projections
+  mutable GLdouble modelViewProjectionMatrix_[16];
+  mutable GLdouble inverseModelViewProjectionMatrix_[16];
+  mutable bool modelViewProjectionMatrixIsUpToDate_;
+  mutable unsigned int modelViewProjectionVersion_;
+  void computeModelViewProjectionMatrix() const;
 
   // S t e r e o   p a r a m e t e r s
   qreal IODistance_;          // inter-ocular distance, in meters
@@ -521,6 +537,9 @@ private:
   // P o i n t s   o f   V i e w s   a n d   K e y F r a m e s
   std::map<unsigned int, KeyFrameInterpolator *> kfi_;
   KeyFrameInterpolator *interpolationKfi_;
+
+  // A s y n c h r o n o u s   d e p t h   r e a d b a c k s
+  DepthQueries *depthQueries_;
 };
 
 } // namespace qglviewer
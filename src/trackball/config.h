@@ -8,7 +8,11 @@
 
 #include <functional>
 #include "Signaler.h"
+#include "Metronom.h"
 #include <string>
+#include <chrono>
+#include <cstdlib>
+#include <set>
 
 // Win 32 DLL export macros
 # ifndef M_PI
@@ -550,7 +554,13 @@ public:
                 _p2 = p2;
         }
         const QPoint center() const {
-                return QPoint(0,0);
+                return QPoint((_p1.x() + _p2.x()) / 2, (_p1.y() + _p2.y()) / 2);
+        }
+        int width() const {
+                return std::abs(_p2.x() - _p1.x()) + 1;
+        }
+        int height() const {
+                return std::abs(_p2.y() - _p1.y()) + 1;
         }
         
         int x() const {
@@ -639,41 +649,6 @@ public:
 
 };
 
-class Metronom : public Signaler {
-public:
-
-  Metronom(): Signaler({"timeout"}) {
-
-  }
-
-  void singleShot(int ms) {
-
-  }
-
-  void start(int ms) {
-
-  }
-
-  int64_t restart() {
-        return 1;
-  }
-
-
-  void stop() {
-
-  }
-
-  void setSingleShot(bool b){
-
-  }
-
-  void start(){
-
-  }
-
-};
-
-
 class QColor {
 
 public:
@@ -0,0 +1,129 @@
+#include "depthQueries.h"
+#include "camera.h"
+#include <opengl/glu.h>
+
+using namespace qglviewer;
+
+DepthQueries::DepthQueries(const Camera *camera) : camera_(camera) {}
+
+DepthQueries::~DepthQueries() { release(); }
+
+/*! Queues the depth read back of \p pixel (origin in the upper left corner).
+ \p callback is called from a later poll(), or from finish(). */
+void DepthQueries::request(const QPoint &pixel, const Callback &callback) {
+  Query query;
+  query.pixel = pixel;
+  query.callback = callback;
+  queued_.push_back(query);
+}
+
+/*! Starts the read back of all the pixels requested since the last flush(),
+ from the depth buffer of the current read framebuffer, which must have been
+ drawn with the current Camera matrices. */
+void DepthQueries::flush() {
+  if (queued_.empty())
+    return;
+
+  Batch batch;
+  if (!free_.empty()) {
+    batch = free_.back();
+    free_.pop_back();
+  }
+  batch.queries.swap(queued_);
+  queued_.clear();
+
+  const GLsizeiptr size = batch.queries.size() * sizeof(GLfloat);
+  if (!batch.pbo)
+    glGenBuffers(1, &batch.pbo);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pbo);
+  if (batch.capacity < size) {
+    batch.capacity = size;
+    glBufferData(GL_PIXEL_PACK_BUFFER, batch.capacity, NULL, GL_STREAM_READ);
+  }
+
+  // Qt uses upper corner for its origin while GL uses the lower corner.
+  const qreal ratio = camera_->devicePixelRatio();
+  for (size_t i = 0; i < batch.queries.size(); ++i) {
+    const QPoint &pixel = batch.queries[i].pixel;
+    glReadPixels(int(pixel.x() * ratio),
+                 int(ratio * (camera_->screenHeight() - pixel.y())) - 1, 1, 1,
+                 GL_DEPTH_COMPONENT, GL_FLOAT,
+                 (void *)(i * sizeof(GLfloat)));
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  camera_->getModelViewMatrix(batch.modelView);
+  camera_->getProjectionMatrix(batch.projection);
+  camera_->getViewport(batch.viewport);
+
+  batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+  inFlight_.push_back(batch);
+}
+
+/*! Answers the flushed batches that the GPU has completed, in order. */
+void DepthQueries::poll() {
+  while (!inFlight_.empty()) {
+    if (glClientWaitSync(inFlight_.front().fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+      return;
+    Batch batch = inFlight_.front();
+    inFlight_.erase(inFlight_.begin());
+    resolve(batch);
+  }
+}
+
+/*! Synchronous fallback: flushes the pending requests and waits until all of
+ them are answered. This stalls the pipeline as a plain \c glReadPixels. */
+void DepthQueries::finish() {
+  flush();
+  while (!inFlight_.empty()) {
+    Batch batch = inFlight_.front();
+    inFlight_.erase(inFlight_.begin());
+    glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    resolve(batch);
+  }
+}
+
+/*! The batch must be signaled. Its callbacks may request and flush again. */
+void DepthQueries::resolve(Batch &batch) {
+  glDeleteSync(batch.fence);
+  batch.fence = nullptr;
+
+  std::vector<GLfloat> depths(batch.queries.size(), 1.0f);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pbo);
+  const GLfloat *data = static_cast<const GLfloat *>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                       depths.size() * sizeof(GLfloat), GL_MAP_READ_BIT));
+  if (data) {
+    depths.assign(data, data + depths.size());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  std::vector<Query> queries;
+  queries.swap(batch.queries);
+  free_.push_back(batch);
+
+  for (size_t i = 0; i < queries.size(); ++i) {
+    GLdouble x, y, z;
+    gluUnProject(queries[i].pixel.x(), queries[i].pixel.y(), depths[i],
+                 batch.modelView, batch.projection, batch.viewport, &x, &y,
+                 &z);
+    queries[i].callback(Vec(x, y, z), static_cast<double>(depths[i]) < 1.0);
+  }
+}
+
+/*! Drops the pending requests and releases the pixel buffers. The GL context
+ must be current. */
+void DepthQueries::release() {
+  queued_.clear();
+  for (Batch &batch : inFlight_) {
+    glDeleteSync(batch.fence);
+    free_.push_back(batch);
+  }
+  inFlight_.clear();
+  for (Batch &batch : free_)
+    if (batch.pbo)
+      glDeleteBuffers(1, &batch.pbo);
+  free_.clear();
+}
@@ -0,0 +1,76 @@
+#ifndef QGLVIEWER_DEPTH_QUERIES_H
+#define QGLVIEWER_DEPTH_QUERIES_H
+
+#include <GL/glew.h>
+#include "config.h"
+#include "vec.h"
+#include <functional>
+#include <vector>
+
+namespace qglviewer {
+class Camera;
+
+/*! \brief Asynchronous depth read backs, used by Camera::pointUnderPixel().
+  \class DepthQueries depthQueries.h QGLViewer/depthQueries.h
+
+  request() only queues a pixel. flush(), called by QGLViewer::paintGL() once
+  the frame is drawn, reads the depths of all the pixels requested during the
+  frame in a single pixel buffer object, followed by a fence, and snapshots the
+  Camera matrices the frame was drawn with. poll(), called at the beginning of
+  the next paintGL(), maps the buffers whose fence is signaled and calls the
+  callbacks with the unprojected points: the result usually arrives one or two
+  frames later, without stalling the GPU pipeline.
+
+  finish() is the synchronous fallback: it flushes and waits for everything.
+
+  The callbacks are called with the GL context current, and may request new
+  queries. */
+class DepthQueries {
+public:
+  /*! Called with the world coordinates of the point under the pixel, and
+  whether a point was found (false on a background pixel). */
+  typedef std::function<void(const Vec &point, bool found)> Callback;
+
+  explicit DepthQueries(const Camera *camera);
+  ~DepthQueries();
+
+  void request(const QPoint &pixel, const Callback &callback);
+  void flush();
+  void poll();
+  void finish();
+
+  /*! True if some requests are not answered yet. */
+  bool isPending() const { return !queued_.empty() || !inFlight_.empty(); }
+
+  void release();
+
+private:
+  DepthQueries(const DepthQueries &);
+  DepthQueries &operator=(const DepthQueries &);
+
+  struct Query {
+    QPoint pixel;
+    Callback callback;
+  };
+  /*! The queries read back by one flush(). */
+  struct Batch {
+    GLuint pbo = 0;
+    GLsizeiptr capacity = 0;
+    GLsync fence = nullptr;
+    std::vector<Query> queries;
+    GLdouble modelView[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+  };
+
+  void resolve(Batch &batch);
+
+  const Camera *camera_;
+  std::vector<Query> queued_;
+  std::vector<Batch> inFlight_;
+  std::vector<Batch> free_; // batches whose pixel buffer can be reused
+};
+
+} // namespace qglviewer
+
+#endif // QGLVIEWER_DEPTH_QUERIES_H
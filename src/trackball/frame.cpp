@@ -1,15 +1,23 @@
 #include "frame.h"
+#include <algorithm>
 #include <math.h>
 #include <opengl/gl.h>
 
 using namespace qglviewer;
 using namespace std;
 
+// Static private variable
+unsigned int Frame::modificationCount_ = 0;
+
 /*! Creates a default Frame.
 
   Its position() is (0,0,0) and it has an identity orientation() Quaternion. The
   referenceFrame() and the constraint() are \c nullptr. */
-Frame::Frame() : Signaler({"modified"}), constraint_(nullptr), referenceFrame_(nullptr) {}
+Frame::Frame()
+    : constraint_(nullptr), referenceFrame_(nullptr), worldIsUpToDate_(false),
+      worldMatrixIsUpToDate_(false), matrixIsUpToDate_(false) {
+  addSignals();
+}
 
 /*! Creates a Frame with a position() and an orientation().
 
@@ -19,7 +27,31 @@ Frame::Frame() : Signaler({"modified"}), constraint_(nullptr), referenceFrame_(n
  The Frame is defined in the world coordinate system (its referenceFrame() is \c
  nullptr). It has a \c nullptr associated constraint(). */
 Frame::Frame(const Vec &position, const Quaternion &orientation)
-    : Signaler({"modified"}), t_(position), q_(orientation), constraint_(nullptr), referenceFrame_(nullptr) {}
+    : t_(position), q_(orientation), constraint_(nullptr), referenceFrame_(nullptr),
+      worldIsUpToDate_(false), worldMatrixIsUpToDate_(false),
+      matrixIsUpToDate_(false) {
+  addSignals();
+}
+
+/*! Virtual destructor.
+
+  The Frame is removed from the children of its referenceFrame(). The Frames
+  that use it as their referenceFrame() are attached to the world coordinate
+  system instead (their translation() and rotation() are unchanged): their
+  position() changes, and they emit modified() once all of them are detached.
+  Their slots must not destroy the other children. */
+Frame::~Frame() {
+  if (referenceFrame_) {
+    std::vector<Frame *> &siblings = referenceFrame_->children_;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+  }
+  std::vector<Frame *> children;
+  children.swap(children_);
+  for (Frame *child : children)
+    child->referenceFrame_ = nullptr;
+  for (Frame *child : children)
+    child->emitModified();
+}
 
 /*! Equal operator.
 
@@ -39,10 +71,21 @@ Frame &Frame::operator=(const Frame &frame) {
 
   The translation() and rotation() as well as constraint() and referenceFrame()
   pointers are copied. */
-Frame::Frame(const Frame &frame) :Signaler({"modified"}) { 
+Frame::Frame(const Frame &frame)
+    : Signaler(), constraint_(nullptr), referenceFrame_(nullptr),
+      worldIsUpToDate_(false), worldMatrixIsUpToDate_(false),
+      matrixIsUpToDate_(false) {
+  addSignals();
   (*this) = frame; 
 }
 
+/* Registers the typed signals under their historical names, for the string
+   based Signaler::connect(). */
+void Frame::addSignals() {
+  addSignal("modified", modified);
+  addSignal("interpolated", interpolated);
+}
+
 /////////////////////////////// MATRICES //////////////////////////////////////
 
 /*! Returns the 4x4 OpenGL transformation matrix represented by the Frame.
@@ -87,9 +130,8 @@ Frame::Frame(const Frame &frame) :Signaler({"modified"}) {
   transformation matrix (i.e. from the world to the Frame coordinate system).
   These two match when the referenceFrame() is \c nullptr.
 
-  The result is only valid until the next call to matrix(), getMatrix(),
-  worldMatrix() or getWorldMatrix(). Use it immediately (as above) or use
-  getMatrix() instead.
+  The result points into the Frame, which caches it until the Frame is
+  modified. Use it immediately (as above) or use getMatrix() instead.
 
   \attention The OpenGL format of the result is the transpose of the actual
   mathematical European representation (translation is on the last \e line
@@ -97,9 +139,11 @@ Frame::Frame(const Frame &frame) :Signaler({"modified"}) {
 
   \note The scaling factor of the 4x4 matrix is 1.0. */
 const GLdouble *Frame::matrix() const {
-  static GLdouble m[4][4];
-  getMatrix(m);
-  return (const GLdouble *)(m);
+  if (!matrixIsUpToDate_) {
+    getMatrix(matrix_);
+    matrixIsUpToDate_ = true;
+  }
+  return matrix_;
 }
 
 /*! \c GLdouble[4][4] version of matrix(). See also getWorldMatrix() and
@@ -167,21 +211,21 @@ Frame Frame::inverse() const {
   European representation (translation is on the last \e line instead of the
   last \e column).
 
-  \attention The result is only valid until the next call to matrix(),
-  getMatrix(), worldMatrix() or getWorldMatrix(). Use it immediately (as above)
-  or use getWorldMatrix() instead.
+  The result points into the Frame, which caches it until the Frame or one of
+  its referenceFrame() is modified. Use it immediately (as above) or use
+  getWorldMatrix() instead.
 
   \note The scaling factor of the 4x4 matrix is 1.0. */
 const GLdouble *Frame::worldMatrix() const {
-  // This test is done for efficiency reasons (creates lots of temp objects
-  // otherwise).
-  if (referenceFrame()) {
-    static Frame fr;
-    fr.setTranslation(position());
-    fr.setRotation(orientation());
-    return fr.matrix();
-  } else
-    return matrix();
+  if (!worldMatrixIsUpToDate_) {
+    computeWorld();
+    orientation_.getMatrix(worldMatrix_);
+    worldMatrix_[12] = position_[0];
+    worldMatrix_[13] = position_[1];
+    worldMatrix_[14] = position_[2];
+    worldMatrixIsUpToDate_ = true;
+  }
+  return worldMatrix_;
 }
 
 /*! qreal[4][4] parameter version of worldMatrix(). See also getMatrix() and
@@ -217,7 +261,7 @@ void Frame::setFromMatrix(const GLdouble m[4][4]) {
       rot[i][j] = m[j][i] / m[3][3];
   }
   q_.setFromRotationMatrix(rot);
-  emit("modified");
+  emitModified();
 }
 
 /*! Sets the Frame from an OpenGL matrix representation (rotation in the upper
@@ -308,7 +352,7 @@ void Frame::translate(Vec &t) {
   if (constraint())
     constraint()->constrainTranslation(t, this);
   t_ += t;
-  emit("modified");
+  emitModified();
 }
 
 /*! Same as translate(const Vec&) but with \c qreal parameters. */
@@ -348,7 +392,7 @@ void Frame::rotate(Quaternion &q) {
     constraint()->constrainRotation(q, this);
   q_ *= q;
   q_.normalize(); // Prevents numerical drift
-  emit("modified");
+  emitModified();
 }
 
 /*! Same as rotate(Quaternion&) but with \c qreal Quaternion parameters. */
@@ -385,6 +429,9 @@ void Frame::rotateAroundPoint(Quaternion &rotation, const Vec &point) {
     constraint()->constrainRotation(rotation, this);
   q_ *= rotation;
   q_.normalize(); // Prevents numerical drift
+  // The translation below is computed in the rotated Frame
+  matrixIsUpToDate_ = false;
+  invalidateWorld();
   Vec trans = point +
               Quaternion(inverseTransformOf(rotation.axis()), rotation.angle())
                   .rotate(position() - point) -
@@ -392,7 +439,7 @@ void Frame::rotateAroundPoint(Quaternion &rotation, const Vec &point) {
   if (constraint())
     constraint()->constrainTranslation(trans, this);
   t_ += trans;  
-  emit("modified");
+  emitModified();
 }
 
 /*! Same as rotateAroundPoint(), but with a \c const \p rotation Quaternion.
@@ -438,7 +485,7 @@ void Frame::setPositionAndOrientation(const Vec &position,
     t_ = position;
     q_ = orientation;
   }
-  emit("modified");
+  emitModified();
 }
 
 /*! Same as successive calls to setTranslation() and then setRotation().
@@ -450,7 +497,7 @@ void Frame::setTranslationAndRotation(const Vec &translation,
                                       const Quaternion &rotation) {
   t_ = translation;
   q_ = rotation;
-  emit("modified");
+  emitModified();
 }
 
 /*! \p x, \p y and \p z are set to the position() of the Frame. */
@@ -495,24 +542,52 @@ void Frame::getOrientation(qreal &q0, qreal &q1, qreal &q2, qreal &q3) const {
 }
 
 /*! Returns the position of the Frame, defined in the world coordinate system.
-   See also orientation(), setPosition() and translation(). */
+   See also orientation(), setPosition() and translation().
+
+   The world position and orientation are cached: they are only recomputed
+   after the Frame or one of its referenceFrame() was modified, so that
+   querying a deep Frame hierarchy is not proportional to its depth. */
 Vec Frame::position() const {
-  if (referenceFrame_)
-    return inverseCoordinatesOf(Vec(0.0, 0.0, 0.0));
-  else
-    return t_;
+  computeWorld();
+  return position_;
 }
 
 /*! Returns the orientation of the Frame, defined in the world coordinate
   system. See also position(), setOrientation() and rotation(). */
 Quaternion Frame::orientation() const {
-  Quaternion res = rotation();
-  const Frame *fr = referenceFrame();
-  while (fr != nullptr) {
-    res = fr->rotation() * res;
-    fr = fr->referenceFrame();
+  computeWorld();
+  return orientation_;
+}
+
+/*! Updates the cached position() and orientation(), from the (cached) ones of
+ the referenceFrame(). Only the out of date part of the chain is computed.
+
+ This writes into const Frames, the reason why a Frame hierarchy must not be
+ read from several threads while out of date (see the Frame documentation). */
+void Frame::computeWorld() const {
+  if (worldIsUpToDate_)
+    return;
+  if (referenceFrame_) {
+    referenceFrame_->computeWorld();
+    position_ = referenceFrame_->position_ +
+                referenceFrame_->orientation_.rotate(t_);
+    orientation_ = referenceFrame_->orientation_ * q_;
+  } else {
+    position_ = t_;
+    orientation_ = q_;
   }
-  return res;
+  worldIsUpToDate_ = true;
+}
+
+/*! Marks the world transform of the Frame and of its descendants out of date.
+ Stops at Frames that already are: their descendants are too. */
+void Frame::invalidateWorld() const {
+  if (!worldIsUpToDate_)
+    return;
+  worldIsUpToDate_ = false;
+  worldMatrixIsUpToDate_ = false;
+  for (Frame *child : children_)
+    child->invalidateWorld();
 }
 
 ////////////////////// C o n s t r a i n t   V e r s i o n s
@@ -545,8 +620,9 @@ void Frame::setRotationWithConstraint(Quaternion &rotation) {
   // Prevent numerical drift
   deltaQ.normalize();
 
-  setRotation(this->rotation() * deltaQ);
-  q_.normalize();
+  Quaternion q = this->rotation() * deltaQ;
+  q.normalize();
+  setRotation(q);
   rotation = this->rotation();
 }
 
@@ -572,7 +648,7 @@ void Frame::setTranslationAndRotationWithConstraint(Vec &translation,
   translation = this->translation();
   rotation = this->rotation();
 
-  emit("modified");
+  emitModified();
 }
 
 /*! Same as setPosition(), but \p position is modified so that the potential
@@ -628,9 +704,16 @@ void Frame::setReferenceFrame(const Frame *const refFrame) {
     std::cerr << "Frame::setReferenceFrame would create a loop in Frame hierarchy" << std::endl;
   else {
     bool identical = (referenceFrame_ == refFrame);
+    if (identical)
+      return;
+    if (referenceFrame_) {
+      std::vector<Frame *> &siblings = referenceFrame_->children_;
+      siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+    }
     referenceFrame_ = refFrame;
-    if (!identical)
-      emit("modified");
+    if (referenceFrame_)
+      referenceFrame_->children_.push_back(this);
+    emitModified();
   }
 }
 
@@ -658,10 +741,8 @@ bool Frame::settingAsReferenceFrameWillCreateALoop(const Frame *const frame) {
  See the <a href="../examples/frameTransform.html">frameTransform example</a>
  for an illustration. */
 Vec Frame::coordinatesOf(const Vec &src) const {
-  if (referenceFrame())
-    return localCoordinatesOf(referenceFrame()->coordinatesOf(src));
-  else
-    return localCoordinatesOf(src);
+  computeWorld();
+  return orientation_.inverseRotate(src - position_);
 }
 
 /*! Returns the world coordinates of the point whose position in the Frame
@@ -670,13 +751,8 @@ Vec Frame::coordinatesOf(const Vec &src) const {
   coordinatesOf() performs the inverse convertion. Use inverseTransformOf() to
   transform 3D vectors instead of 3D coordinates. */
 Vec Frame::inverseCoordinatesOf(const Vec &src) const {
-  const Frame *fr = this;
-  Vec res = src;
-  while (fr != nullptr) {
-    res = fr->localInverseCoordinatesOf(res);
-    fr = fr->referenceFrame();
-  }
-  return res;
+  computeWorld();
+  return orientation_.rotate(src) + position_;
 }
 
 /*! Returns the Frame coordinates of a point \p src defined in the
@@ -790,10 +866,8 @@ void Frame::getCoordinatesOfFrom(const qreal src[3], qreal res[3],
  See the <a href="../examples/frameTransform.html">frameTransform example</a>
  for an illustration. */
 Vec Frame::transformOf(const Vec &src) const {
-  if (referenceFrame())
-    return localTransformOf(referenceFrame()->transformOf(src));
-  else
-    return localTransformOf(src);
+  computeWorld();
+  return orientation_.inverseRotate(src);
 }
 
 /*! Returns the world transform of the vector whose coordinates in the Frame
@@ -802,13 +876,8 @@ Vec Frame::transformOf(const Vec &src) const {
   transformOf() performs the inverse transformation. Use inverseCoordinatesOf()
   to transform 3D coordinates instead of 3D vectors. */
 Vec Frame::inverseTransformOf(const Vec &src) const {
-  const Frame *fr = this;
-  Vec res = src;
-  while (fr != nullptr) {
-    res = fr->localInverseTransformOf(res);
-    fr = fr->referenceFrame();
-  }
-  return res;
+  computeWorld();
+  return orientation_.rotate(src);
 }
 
 /*! Returns the Frame transform of a vector \p src defined in the
@@ -3,6 +3,7 @@
 
 #include "constraint.h"
 #include <functional>
+#include <vector>
 #include "Signaler.h"
 
 // #include "GL/gl.h" is now included in config.h for ease of configuration
@@ -102,6 +103,16 @@ namespace qglviewer {
   WorldConstraint and CameraConstraint) and new constraints can very easily be
   implemented.
 
+  <h3>Threads</h3>
+
+  Frames are not thread safe, not even for reading: the const position(),
+  orientation(), matrix() and worldMatrix() (and the methods based on them)
+  fill caches of the Frame and of its referenceFrame() chain on demand. A Frame
+  hierarchy belongs to one thread. If other threads have to read it while it
+  is not modified, first call worldMatrix() and matrix() on each of its Frames
+  from the owning thread: the const methods then only read. Use a
+  TransformSystem to update many transforms in parallel.
+
   <h3>Derived classes</h3>
 
   The ManipulatedFrame class inherits Frame and implements a mouse motion
@@ -114,8 +125,7 @@ class Frame  : public Signaler {
 public:
   Frame();
 
-  /*! Virtual destructor. Empty. */
-  virtual ~Frame() {}
+  virtual ~Frame();
 
   Frame(const Frame &frame);
   Frame &operator=(const Frame &frame);
@@ -156,7 +166,7 @@ public:
   of the Frame. */
   void setTranslation(const Vec &translation) {
     t_ = translation;
-    emit("modified");
+    emitModified();
   }
   void setTranslation(qreal x, qreal y, qreal z);
   void setTranslationWithConstraint(Vec &translation);
@@ -173,7 +183,7 @@ public:
    setRotationWithConstraint() instead. */
   void setRotation(const Quaternion &rotation) {
     q_ = rotation;
-    emit("modified");
+    emitModified();
   }
   void setRotation(qreal q0, qreal q1, qreal q2, qreal q3);
   void setRotationWithConstraint(Quaternion &rotation);
@@ -371,7 +381,43 @@ public:
   }
   //@}
 
+  /*! @name Signals */
+  //@{
+public:
+  /*! This signal is emitted whenever the position() or the orientation() of
+  the Frame is modified.
+
+  Connect this signal to any object that must be notified:
+  \code
+  frame->modified.connect(std::bind(&Viewer::update, viewer), viewer);
+  \endcode
+
+  \note If your Frame is part of a Frame hierarchy, only the modified Frame
+  emits this signal, not its children. */
+  TypedSignal<> modified;
+
+  /*! This signal is emitted when the Frame is interpolated by a
+  KeyFrameInterpolator. See KeyFrameInterpolator::setFrame(). */
+  TypedSignal<> interpolated;
+
+  /*! Returns the total number of modifications of all the Frames. Caches that
+  depend on Frame positions (see MouseGrabberIndex) compare it to know whether
+  they are still valid, including when a referenceFrame() moved. */
+  static unsigned int modificationCount() { return modificationCount_; }
+  //@}
+
 private:
+  void addSignals();
+  void emitModified() {
+    matrixIsUpToDate_ = false;
+    invalidateWorld();
+    ++modificationCount_;
+    modified.emit();
+  }
+  void invalidateWorld() const;
+  void computeWorld() const;
+  static unsigned int modificationCount_;
+
   // P o s i t i o n   a n d   o r i e n t a t i o n
   Vec t_;
   Quaternion q_;
@@ -381,6 +427,20 @@ private:
 
   // F r a m e   c o m p o s i t i o n
   const Frame *referenceFrame_;
+  // Frames whose referenceFrame() is this one, invalidated with it
+  mutable std::vector<Frame *> children_;
+
+  // C a c h e d   t r a n s f o r m s
+  // Invariant: when the world transform of a Frame is out of date, so are
+  // those of all its descendants. Filled by the const getters, without any
+  // synchronization: see the Threads section above.
+  mutable Vec position_;
+  mutable Quaternion orientation_;
+  mutable bool worldIsUpToDate_;
+  mutable GLdouble worldMatrix_[16];
+  mutable bool worldMatrixIsUpToDate_;
+  mutable GLdouble matrix_[16];
+  mutable bool matrixIsUpToDate_;
 
 };
 
@@ -0,0 +1,282 @@
+#include "idBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+using namespace qglviewer;
+
+namespace {
+const char *vertexCode = R"(#version 330 core
+layout (location = 0) in vec3 position;
+
+uniform mat4 projection;
+uniform mat4 modelView;
+
+void main()
+{
+	gl_Position = projection * modelView * vec4(position, 1.0);
+}
+)";
+
+// the modelview is the fixed function one, as set by glMultMatrix() & co at the
+// time of the draw
+const char *compatibilityVertexCode = R"(#version 330 compatibility
+layout (location = 0) in vec3 position;
+
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * gl_ModelViewMatrix * vec4(position, 1.0);
+}
+)";
+
+const char *fragmentCode = R"(#version 330 core
+uniform uint name;
+
+layout (location = 0) out uint id;
+
+void main()
+{
+	id = name;
+}
+)";
+} // namespace
+
+IdBuffer::IdBuffer()
+    : fbo_(0), ids_(0), depth_(0), pbo_(0), program_(0), nameLocation_(-1),
+      projectionLocation_(-1), modelViewLocation_(-1),
+      fixedFunction_(false), fence_(nullptr), width_(0), height_(0),
+      capacityWidth_(0), capacityHeight_(0), name_(-1), previousFbo_(0),
+      previousProgram_(0), previousDepthTest_(GL_FALSE),
+      previousDepthMask_(GL_TRUE) {}
+
+/*! Contexts before 3.2 have no profile, and are compatibility ones. */
+void IdBuffer::initProgram() {
+  GLint major = 0, minor = 0, profile = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  if (major > 3 || (major == 3 && minor >= 2))
+    glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+  fixedFunction_ = !(profile & GL_CONTEXT_CORE_PROFILE_BIT);
+
+  GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex, 1,
+                 fixedFunction_ ? &compatibilityVertexCode : &vertexCode,
+                 NULL);
+  glCompileShader(vertex);
+  GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment, 1, &fragmentCode, NULL);
+  glCompileShader(fragment);
+
+  program_ = glCreateProgram();
+  glAttachShader(program_, vertex);
+  glAttachShader(program_, fragment);
+  glLinkProgram(program_);
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+
+  GLint success;
+  glGetProgramiv(program_, GL_LINK_STATUS, &success);
+  if (!success) {
+    char infoLog[1024];
+    glGetProgramInfoLog(program_, 1024, NULL, infoLog);
+    std::cerr << "ERROR::IDBUFFER::PROGRAM_LINKING_ERROR\n"
+              << infoLog << std::endl;
+  }
+
+  nameLocation_ = glGetUniformLocation(program_, "name");
+  projectionLocation_ = glGetUniformLocation(program_, "projection");
+  modelViewLocation_ = glGetUniformLocation(program_, "modelView");
+}
+
+/*! The attachments only grow: a selection region is usually a few pixels, and
+ stays the same from one selection to the next. */
+void IdBuffer::allocate(int width, int height) {
+  if (width <= capacityWidth_ && height <= capacityHeight_)
+    return;
+  capacityWidth_ = std::max(width, capacityWidth_);
+  capacityHeight_ = std::max(height, capacityHeight_);
+
+  if (!fbo_) {
+    glGenFramebuffers(1, &fbo_);
+    glGenRenderbuffers(1, &ids_);
+    glGenRenderbuffers(1, &depth_);
+    glGenBuffers(1, &pbo_);
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glBindRenderbuffer(GL_RENDERBUFFER, ids_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, capacityWidth_,
+                        capacityHeight_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, ids_);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, capacityWidth_,
+                        capacityHeight_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                            GL_RENDERBUFFER, depth_);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::cerr << "ERROR::IDBUFFER:: Framebuffer is not complete!" << std::endl;
+
+  // ids then depths
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_);
+  glBufferData(GL_PIXEL_PACK_BUFFER,
+               capacityWidth_ * capacityHeight_ *
+                   (sizeof(GLuint) + sizeof(GLfloat)),
+               NULL, GL_STREAM_READ);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+/*! Binds the id framebuffer, of \p width x \p height pixels, and the id
+ program, and enables the depth test. The current framebuffer, viewport,
+ program, depth test and depth mask are restored by end(), as well as the fixed
+ function modelview in a compatibility context. A selection still pending is
+ dropped. */
+void IdBuffer::begin(int width, int height, const GLfloat projection[16],
+                     const GLfloat modelView[16]) {
+  if (fence_) {
+    glDeleteSync(fence_);
+    fence_ = nullptr;
+  }
+  if (!program_)
+    initProgram();
+
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFbo_);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram_);
+  glGetIntegerv(GL_VIEWPORT, previousViewport_);
+  glGetBooleanv(GL_DEPTH_TEST, &previousDepthTest_);
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &previousDepthMask_);
+
+  width_ = std::max(width, 1);
+  height_ = std::max(height, 1);
+  allocate(width_, height_);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glViewport(0, 0, width_, height_);
+  glEnable(GL_DEPTH_TEST);
+  glDepthMask(GL_TRUE);
+  const GLuint none[4] = {0, 0, 0, 0};
+  glClearBufferuiv(GL_COLOR, 0, none);
+  const GLfloat far = 1.0f;
+  glClearBufferfv(GL_DEPTH, 0, &far);
+
+  glUseProgram(program_);
+  glUniformMatrix4fv(projectionLocation_, 1, GL_FALSE, projection);
+  if (fixedFunction_) {
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+  }
+  setModelView(modelView);
+  setName(-1);
+}
+
+/*! Sets the name written by the next draws, -1 for none. */
+void IdBuffer::setName(int name) {
+  name_ = name;
+  glUniform1ui(nameLocation_, static_cast<GLuint>(name + 1));
+}
+
+/*! Sets the modelview of the next draws. In a compatibility context it is
+ loaded in the fixed function \c GL_MODELVIEW matrix, which the draws may then
+ also change with \c glPushMatrix(), \c glMultMatrix() and the like. */
+void IdBuffer::setModelView(const GLfloat modelView[16]) {
+  if (fixedFunction_) {
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(modelView);
+  } else
+    glUniformMatrix4fv(modelViewLocation_, 1, GL_FALSE, modelView);
+}
+
+/*! Starts the read back of the region and restores the previous state. */
+void IdBuffer::end() {
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glReadPixels(0, 0, width_, height_, GL_RED_INTEGER, GL_UNSIGNED_INT,
+               (void *)0);
+  glReadPixels(0, 0, width_, height_, GL_DEPTH_COMPONENT, GL_FLOAT,
+               (void *)(width_ * height_ * sizeof(GLuint)));
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+
+  glBindFramebuffer(GL_FRAMEBUFFER, previousFbo_);
+  glViewport(previousViewport_[0], previousViewport_[1], previousViewport_[2],
+             previousViewport_[3]);
+  if (!previousDepthTest_)
+    glDisable(GL_DEPTH_TEST);
+  glDepthMask(previousDepthMask_);
+  if (fixedFunction_) {
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+  }
+  glUseProgram(previousProgram_);
+}
+
+/*! Decodes the last read back. Without \p wait, returns false (and nothing is
+ modified) while the GPU has not finished it. \p closest is the name of the
+ closest drawn pixel (-1 if none) and \p names the sorted names of all the
+ objects visible in the region. */
+bool IdBuffer::result(int &closest, std::vector<int> &names, bool wait) {
+  if (!fence_)
+    return false;
+
+  GLenum status = glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                   wait ? 1000000000 : 0);
+  if (status == GL_TIMEOUT_EXPIRED)
+    return false;
+  glDeleteSync(fence_);
+  fence_ = nullptr;
+
+  const int count = width_ * height_;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_);
+  const char *data = static_cast<const char *>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                       count * (sizeof(GLuint) + sizeof(GLfloat)),
+                       GL_MAP_READ_BIT));
+
+  closest = -1;
+  names.clear();
+  if (data) {
+    const GLuint *ids = reinterpret_cast<const GLuint *>(data);
+    const GLfloat *depths =
+        reinterpret_cast<const GLfloat *>(data + count * sizeof(GLuint));
+    GLfloat zMin = std::numeric_limits<GLfloat>::max();
+    for (int i = 0; i < count; ++i) {
+      if (ids[i] == 0)
+        continue;
+      names.push_back(int(ids[i]) - 1);
+      if (depths[i] < zMin) {
+        zMin = depths[i];
+        closest = int(ids[i]) - 1;
+      }
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  return true;
+}
+
+void IdBuffer::release() {
+  if (fence_)
+    glDeleteSync(fence_);
+  fence_ = nullptr;
+  if (fbo_) {
+    glDeleteFramebuffers(1, &fbo_);
+    glDeleteRenderbuffers(1, &ids_);
+    glDeleteRenderbuffers(1, &depth_);
+    glDeleteBuffers(1, &pbo_);
+  }
+  if (program_)
+    glDeleteProgram(program_);
+  fbo_ = ids_ = depth_ = pbo_ = program_ = 0;
+  capacityWidth_ = capacityHeight_ = 0;
+}
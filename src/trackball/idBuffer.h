@@ -0,0 +1,74 @@
+#ifndef QGLVIEWER_ID_BUFFER_H
+#define QGLVIEWER_ID_BUFFER_H
+
+#include <GL/glew.h>
+#include <vector>
+
+namespace qglviewer {
+/*! \brief Offscreen object id rendering, used by QGLViewer::select().
+  \class IdBuffer idBuffer.h QGLViewer/idBuffer.h
+
+  Between begin() and end(), the draws write the current name() in an unsigned
+  integer color attachment, with a depth test so that each pixel keeps the
+  closest object. The framebuffer only covers the selection region: the
+  projection given to begin() is already restricted to it (as with
+  gluPickMatrix()).
+
+  end() starts an asynchronous read back of the ids and depths in a pixel buffer
+  object, fenced. result() then returns false until the GPU is done (unless
+  asked to wait), and decodes the closest name and the list of all the names
+  seen in the region.
+
+  The name is a uniform of the id program, bound by begin(): draws only have to
+  provide their positions in attribute 0. Programs of your own can write the
+  id themselves, in a \c uint output at location 0 (name + 1, 0 meaning no
+  object).
+
+  In a compatibility context the id program uses the fixed function modelview
+  of each draw, so that \c glPushMatrix() / \c glMultMatrix() blocks are
+  honored as with \c GL_SELECT. A core profile has none: the draws set their
+  modelview with setModelView(). The legacy \c glPushName() and \c
+  glLoadName() have no effect outside of \c GL_SELECT, the names are only set
+  with setName(). */
+class IdBuffer {
+public:
+  IdBuffer();
+
+  void begin(int width, int height, const GLfloat projection[16],
+             const GLfloat modelView[16]);
+  void setName(int name);
+  int name() const { return name_; }
+  void setModelView(const GLfloat modelView[16]);
+  /*! True when the draws use the fixed function modelview, see setModelView().
+  Known once begin() was called. */
+  bool usesFixedFunction() const { return fixedFunction_; }
+  void end();
+
+  /*! True between end() and the result() that returned the read back. */
+  bool isPending() const { return fence_ != nullptr; }
+  bool result(int &closest, std::vector<int> &names, bool wait);
+
+  /*! Releases the GL objects, recreated on demand. */
+  void release();
+
+private:
+  void initProgram();
+  void allocate(int width, int height);
+
+  GLuint fbo_, ids_, depth_, pbo_, program_;
+  GLint nameLocation_, projectionLocation_, modelViewLocation_;
+  bool fixedFunction_;
+  GLsync fence_;
+  int width_, height_;          // current region
+  int capacityWidth_, capacityHeight_;
+  int name_;
+
+  // state restored by end()
+  GLint previousFbo_, previousProgram_;
+  GLint previousViewport_[4];
+  GLboolean previousDepthTest_, previousDepthMask_;
+};
+
+} // namespace qglviewer
+
+#endif // QGLVIEWER_ID_BUFFER_H
@@ -1,6 +1,6 @@
 #include "qglviewer.h" // for QGLViewer::drawAxis and Camera::drawCamera
-#include <algorithm>    // std::for_each
-#include <iterator>
+#include <algorithm>    // std::lower_bound
+#include <cmath>
 
 using namespace qglviewer;
 using namespace std;
@@ -12,33 +12,37 @@ using namespace std;
   interpolationTime(), interpolationSpeed() and interpolationPeriod() are set to
   their default values. */
 KeyFrameInterpolator::KeyFrameInterpolator(Frame *frame)
-    : Signaler({"interpolated", "endReached"}),
+    : pathBuffer_(0), pathBufferIsValid_(false), samplesPerSecond_(0.0),
+      arcLengthParameterization_(false), bakedIsValid_(false),
       frame_(nullptr), period_(40), interpolationTime_(0.0),
       interpolationSpeed_(1.0), interpolationStarted_(false),
       loopInterpolation_(false), pathIsValid_(false),
       valuesAreValid_(true), currentFrameValid_(false)
 {
+  addSignal("interpolated", interpolated);
+  addSignal("endReached", endReached);
   setFrame(frame);
   for (int i = 0; i < 4; ++i)
-    currentFrame_.push_back(keyFrame_.begin());
-  timer_.connect("timeout", std::bind(&KeyFrameInterpolator::update, this), this);
+    currentFrame_[i] = 0;
+  timer_.timeout.connect(std::bind(&KeyFrameInterpolator::update, this), this);
 }
 
 /*! Virtual destructor. Clears the keyFrame path. */
 KeyFrameInterpolator::~KeyFrameInterpolator() {
   deletePath();
+  if (pathBuffer_)
+    glDeleteBuffers(1, &pathBuffer_);
 }
 
 /*! Sets the frame() associated to the KeyFrameInterpolator. */
 void KeyFrameInterpolator::setFrame(Frame *const frame) {
   if (this->frame())
-    this->disconnect("interpolated", this->frame());
-
+    interpolated.disconnect(this->frame());
 
   frame_ = frame;
 
   if (this->frame())
-    this->connect("interpolated", this->frame()->signal("interpolated"), this->frame());
+    interpolated.connect([frame]() { frame->interpolated.emit(); }, frame);
 }
 
 /*! Updates frame() state according to current interpolationTime(). Then adds
@@ -53,26 +57,26 @@ void KeyFrameInterpolator::update() {
 
   interpolationTime_ += interpolationSpeed() * interpolationPeriod() / 1000.0;
 
-  if (interpolationTime() > keyFrame_.back()->time()) {
+  if (interpolationTime() > keyFrame_.back().time()) {
     if (loopInterpolation())
-      setInterpolationTime(keyFrame_.front()->time() + interpolationTime_ -
-                           keyFrame_.back()->time());
+      setInterpolationTime(keyFrame_.front().time() + interpolationTime_ -
+                           keyFrame_.back().time());
     else {
       // Make sure last KeyFrame is reached and displayed
-      interpolateAtTime(keyFrame_.back()->time());
+      interpolateAtTime(keyFrame_.back().time());
       stopInterpolation();
     }
-    emit("endReached");
-  } else if (interpolationTime() < keyFrame_.front()->time()) {
+    endReached.emit();
+  } else if (interpolationTime() < keyFrame_.front().time()) {
     if (loopInterpolation())
-      setInterpolationTime(keyFrame_.back()->time() -
-                           keyFrame_.front()->time() + interpolationTime_);
+      setInterpolationTime(keyFrame_.back().time() -
+                           keyFrame_.front().time() + interpolationTime_);
     else {
       // Make sure first KeyFrame is reached and displayed
-      interpolateAtTime(keyFrame_.front()->time());
+      interpolateAtTime(keyFrame_.front().time());
       stopInterpolation();
     }
-    emit("endReached");
+    endReached.emit();
   }
 }
 
@@ -107,11 +111,11 @@ void KeyFrameInterpolator::startInterpolation(int period) {
 
   if (!keyFrame_.empty()) {
     if ((interpolationSpeed() > 0.0) &&
-        (interpolationTime() >= keyFrame_.back()->time()))
-      setInterpolationTime(keyFrame_.front()->time());
+        (interpolationTime() >= keyFrame_.back().time()))
+      setInterpolationTime(keyFrame_.front().time());
     if ((interpolationSpeed() < 0.0) &&
-        (interpolationTime() <= keyFrame_.front()->time()))
-      setInterpolationTime(keyFrame_.back()->time());
+        (interpolationTime() <= keyFrame_.front().time()))
+      setInterpolationTime(keyFrame_.back().time());
     timer_.start(interpolationPeriod());
     interpolationStarted_ = true;
     update();
@@ -154,14 +158,15 @@ void KeyFrameInterpolator::addKeyFrame(Frame * frame, qreal time) {
   if (keyFrame_.empty())
     interpolationTime_ = time;
 
-  if ((!keyFrame_.empty()) && (keyFrame_.back()->time() > time))
+  if ((!keyFrame_.empty()) && (keyFrame_.back().time() > time))
     std::cerr << "Error in KeyFrameInterpolator::addKeyFrame: time is not monotone" << std::endl;
   else
-    keyFrame_.push_back(new KeyFrame(frame, time));
-  frame->connect("modified", std::bind(&KeyFrameInterpolator::invalidateValues, this), this);
+    keyFrame_.push_back(KeyFrame(frame, time));
+  frame->modified.connect(std::bind(&KeyFrameInterpolator::invalidateValues, this), this);
   valuesAreValid_ = false;
   pathIsValid_ = false;
   currentFrameValid_ = false;
+  bakedIsValid_ = false;
   resetInterpolation();
 }
 
@@ -177,14 +182,15 @@ void KeyFrameInterpolator::addKeyFrame(Frame &frame, qreal time) {
   if (keyFrame_.empty())
     interpolationTime_ = time;
 
-  if ((!keyFrame_.empty()) && (keyFrame_.back()->time() > time))
+  if ((!keyFrame_.empty()) && (keyFrame_.back().time() > time))
     std::cerr << "Error in KeyFrameInterpolator::addKeyFrame: time is not monotone" << std::endl;
   else
-    keyFrame_.push_back(new KeyFrame(frame, time));
+    keyFrame_.push_back(KeyFrame(frame, time));
 
   valuesAreValid_ = false;
   pathIsValid_ = false;
   currentFrameValid_ = false;
+  bakedIsValid_ = false;
   resetInterpolation();
 }
 
@@ -213,7 +219,7 @@ void KeyFrameInterpolator::addKeyFrame(Frame &frame) {
   if (keyFrame_.empty())
     time = 0.0;
   else
-    time = keyFrame_.back()->time() + 1.0;
+    time = keyFrame_.back().time() + 1.0;
 
   addKeyFrame(frame, time);
 }
@@ -221,12 +227,11 @@ void KeyFrameInterpolator::addKeyFrame(Frame &frame) {
 /*! Removes all keyFrames from the path. The numberOfKeyFrames() is set to 0. */
 void KeyFrameInterpolator::deletePath() {
   stopInterpolation();
-  for(auto it = keyFrame_.begin() ; it!=keyFrame_.end() ; ++it)
-    delete *it;
   keyFrame_.clear();
   pathIsValid_ = false;
   valuesAreValid_ = false;
   currentFrameValid_ = false;
+  bakedIsValid_ = false;
 }
 
 static void drawCamera(qreal scale) {
@@ -311,7 +316,8 @@ static void drawCamera(qreal scale) {
 void KeyFrameInterpolator::drawPath(int mask, int nbFrames, qreal scale) {
   const int nbSteps = 30;
   if (!pathIsValid_) {
-    path_.clear();
+    pathPosition_.clear();
+    pathOrientation_.clear();
 
     if (keyFrame_.empty())
       return;
@@ -319,47 +325,29 @@ void KeyFrameInterpolator::drawPath(int mask, int nbFrames, qreal scale) {
     if (!valuesAreValid_)
       updateModifiedFrameValues();
 
-    if (keyFrame_.front() == keyFrame_.back())
-      path_.push_back(Frame(keyFrame_.front()->position(),
-                            keyFrame_.front()->orientation()));
-    else {
-      static Frame fr;
-      KeyFrame *kf_[4];
-      kf_[0] = keyFrame_.front();
-      kf_[1] = kf_[0];
-      int index = 1;
-      kf_[2] = (index < keyFrame_.size()) ? *std::next(keyFrame_.begin(),index) : nullptr;
-      index++;
-      kf_[3] = (index < keyFrame_.size()) ? *std::next(keyFrame_.begin(),index) : nullptr;
-
-      while (kf_[2]) {
-        Vec diff = kf_[2]->position() - kf_[1]->position();
-        Vec v1 = 3.0 * diff - 2.0 * kf_[1]->tgP() - kf_[2]->tgP();
-        Vec v2 = -2.0 * diff + kf_[1]->tgP() + kf_[2]->tgP();
-
-        // cout << kf_[0]->time() << " , " << kf_[1]->time() << " , " <<
-        // kf_[2]->time() << " , " << kf_[3]->time() << endl;
-        for (int step = 0; step < nbSteps; ++step) {
-          qreal alpha = step / static_cast<qreal>(nbSteps);
-          fr.setPosition(kf_[1]->position() +
-                         alpha * (kf_[1]->tgP() + alpha * (v1 + alpha * v2)));
-          fr.setOrientation(Quaternion::squad(kf_[1]->orientation(),
-                                              kf_[1]->tgQ(), kf_[2]->tgQ(),
-                                              kf_[2]->orientation(), alpha));
-          path_.push_back(fr);
-        }
-
-        // Shift
-        kf_[0] = kf_[1];
-        kf_[1] = kf_[2];
-        kf_[2] = kf_[3];
-        index++;
-        kf_[3] = (index < keyFrame_.size()) ? *std::next(keyFrame_.begin(),index) : nullptr;
+    const int nbKeyFrames = numberOfKeyFrames();
+    pathPosition_.reserve(nbSteps * (nbKeyFrames - 1) + 1);
+    pathOrientation_.reserve(nbSteps * (nbKeyFrames - 1) + 1);
+    for (int i = 0; i + 1 < nbKeyFrames; ++i) {
+      const KeyFrame &kf1 = keyFrame_[i];
+      const KeyFrame &kf2 = keyFrame_[i + 1];
+      Vec diff = kf2.position() - kf1.position();
+      Vec v1 = 3.0 * diff - 2.0 * kf1.tgP() - kf2.tgP();
+      Vec v2 = -2.0 * diff + kf1.tgP() + kf2.tgP();
+
+      for (int step = 0; step < nbSteps; ++step) {
+        qreal alpha = step / static_cast<qreal>(nbSteps);
+        pathPosition_.push_back(kf1.position() +
+                                alpha * (kf1.tgP() + alpha * (v1 + alpha * v2)));
+        pathOrientation_.push_back(Quaternion::squad(
+            kf1.orientation(), kf1.tgQ(), kf2.tgQ(), kf2.orientation(), alpha));
       }
-      // Add last KeyFrame
-      path_.push_back(Frame(kf_[1]->position(), kf_[1]->orientation()));
     }
+    // Add last KeyFrame
+    pathPosition_.push_back(keyFrame_.back().position());
+    pathOrientation_.push_back(keyFrame_.back().orientation());
     pathIsValid_ = true;
+    pathBufferIsValid_ = false;
   }
 
   if (mask) {
@@ -367,21 +355,47 @@ void KeyFrameInterpolator::drawPath(int mask, int nbFrames, qreal scale) {
     glLineWidth(2);
 
     if (mask & 1) {
-      glBegin(GL_LINE_STRIP);
-      for(std::list<Frame>::iterator fr=path_.begin() ; fr != path_.end() ; ++fr)
-          glVertex3fv(fr->position());
-      glEnd();
+      if (!pathBuffer_)
+        glGenBuffers(1, &pathBuffer_);
+      glBindBuffer(GL_ARRAY_BUFFER, pathBuffer_);
+      if (!pathBufferIsValid_) {
+        std::vector<GLfloat> vertices;
+        vertices.reserve(3 * pathPosition_.size());
+        for (const Vec &position : pathPosition_)
+          for (int i = 0; i < 3; ++i)
+            vertices.push_back(static_cast<GLfloat>(position[i]));
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat),
+                     vertices.data(), GL_STATIC_DRAW);
+        pathBufferIsValid_ = true;
+      }
+
+      // client side vertex array state lives in the default vertex array
+      GLint previousVao;
+      glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVao);
+      glBindVertexArray(0);
+      glEnableClientState(GL_VERTEX_ARRAY);
+      glVertexPointer(3, GL_FLOAT, 0, nullptr);
+      glDrawArrays(GL_LINE_STRIP, 0, GLsizei(pathPosition_.size()));
+      glDisableClientState(GL_VERTEX_ARRAY);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      glBindVertexArray(previousVao);
     }
     if (mask & 6) {
       int count = 0;
       if (nbFrames > nbSteps)
         nbFrames = nbSteps;
       qreal goal = 0.0;
-      for(std::list<Frame>::iterator fr=path_.begin() ; fr != path_.end() ; ++fr)
+      GLdouble m[16];
+      for (size_t i = 0; i < pathPosition_.size(); ++i)
         if ((count++) >= goal) {
           goal += nbSteps / static_cast<qreal>(nbFrames);
+          // same as the Frame::matrix() of a Frame at this position
+          pathOrientation_[i].getMatrix(m);
+          m[12] = pathPosition_[i][0];
+          m[13] = pathPosition_[i][1];
+          m[14] = pathPosition_[i][2];
           glPushMatrix();
-          glMultMatrixd(fr->matrix());
+          glMultMatrixd(m);
           if (mask & 2)
             drawCamera(scale);
           if (mask & 4)
@@ -392,30 +406,21 @@ void KeyFrameInterpolator::drawPath(int mask, int nbFrames, qreal scale) {
   }
 }
 
+/*! Updates the keyFrames defined by a Frame pointer, and the tangents, in a
+ single pass over the keyFrames. */
 void KeyFrameInterpolator::updateModifiedFrameValues() {
-  Quaternion prevQ = keyFrame_.front()->orientation();
-  KeyFrame *kf;
-  for (int i = 0; i < keyFrame_.size(); ++i) {
-    kf = *std::next(keyFrame_.begin(),i);
-    if (kf->frame())
-      kf->updateValuesFromPointer();
-    kf->flipOrientationIfNeeded(prevQ);
-    prevQ = kf->orientation();
+  const int nbKeyFrames = numberOfKeyFrames();
+  Quaternion prevQ = keyFrame_.front().orientation();
+  for (KeyFrame &kf : keyFrame_) {
+    if (kf.frame())
+      kf.updateValuesFromPointer();
+    kf.flipOrientationIfNeeded(prevQ);
+    prevQ = kf.orientation();
   }
 
-  KeyFrame *prev = keyFrame_.front();
-  kf = keyFrame_.front();
-  int index = 1;
-  while (kf) {
-    KeyFrame *next = (index < keyFrame_.size()) ? *std::next(keyFrame_.begin(),index) : nullptr;
-    index++;
-    if (next)
-      kf->computeTangent(prev, next);
-    else
-      kf->computeTangent(prev, kf);
-    prev = kf;
-    kf = next;
-  }
+  for (int i = 0; i < nbKeyFrames; ++i)
+    keyFrame_[i].computeTangent(keyFrame_[std::max(i - 1, 0)],
+                                keyFrame_[std::min(i + 1, nbKeyFrames - 1)]);
   valuesAreValid_ = true;
 }
 
@@ -428,8 +433,8 @@ void KeyFrameInterpolator::updateModifiedFrameValues() {
  addKeyFrame(const Frame* const)), the \e current pointed Frame state is
  returned. */
 Frame KeyFrameInterpolator::keyFrame(int index) const {
-  const KeyFrame *const kf = *std::next(keyFrame_.begin(),index);
-  return Frame(kf->position(), kf->orientation());
+  const KeyFrame &kf = keyFrame_[index];
+  return Frame(kf.position(), kf.orientation());
 }
 
 /*! Returns the time corresponding to the \p index keyFrame.
@@ -437,7 +442,7 @@ Frame KeyFrameInterpolator::keyFrame(int index) const {
  See also keyFrame(). \p index has to be in the range 0..numberOfKeyFrames()-1.
  */
 qreal KeyFrameInterpolator::keyFrameTime(int index) const {
-  return (*(std::next(keyFrame_.begin(),index)))->time();
+  return keyFrame_[index].time();
 }
 
 /*! Returns the duration of the KeyFrameInterpolator path, expressed in seconds.
@@ -456,7 +461,7 @@ qreal KeyFrameInterpolator::firstTime() const {
   if (keyFrame_.empty())
     return 0.0;
   else
-    return keyFrame_.front()->time();
+    return keyFrame_.front().time();
 }
 
 /*! Returns the time corresponding to the last keyFrame, expressed in seconds.
@@ -467,7 +472,7 @@ qreal KeyFrameInterpolator::lastTime() const {
   if (keyFrame_.empty())
     return 0.0;
   else
-    return keyFrame_.back()->time();
+    return keyFrame_.back().time();
 }
 
 void KeyFrameInterpolator::updateCurrentKeyFrameForTime(qreal time) {
@@ -475,58 +480,42 @@ void KeyFrameInterpolator::updateCurrentKeyFrameForTime(qreal time) {
   // Assertion: keyFrame_ is not empty
 
   // TODO: Special case for loops when closed path is implemented !!
-  if (!currentFrameValid_)
-    // Recompute everything from scrach
-    currentFrame_[1] = keyFrame_.begin();
-
-  while ((*std::next(currentFrame_[1]))->time() > time) {
-    currentFrameValid_ = false;
-    if (currentFrame_[1] == keyFrame_.begin())
-      break;
-    std::advance(currentFrame_[1], -1);
-  }
-
-  if (!currentFrameValid_)
-    *currentFrame_[2] = *currentFrame_[1];
-
-  while ((*std::next(currentFrame_[2]))->time() < time) {
-    currentFrameValid_ = false;
-    if (std::next(currentFrame_[2]) == keyFrame_.end())
-      break;
-    std::advance(currentFrame_[2], 1);
-  }
-
-  if (!currentFrameValid_) {
-    currentFrame_[1] = currentFrame_[2];
-    if ((currentFrame_[1] != keyFrame_.begin()) &&
-        (time < (*std::next(currentFrame_[2]))->time()))
-      std::advance(currentFrame_[1], -1);
-
-    *currentFrame_[0] = *currentFrame_[1];
-    if (currentFrame_[0] != keyFrame_.begin())
-      std::advance(currentFrame_[0], -1);
-
-    *currentFrame_[3] = *currentFrame_[2];
-    if (std::next(currentFrame_[3]) != keyFrame_.end())
-      std::advance(currentFrame_[3], 1);
+  const int nbKeyFrames = numberOfKeyFrames();
+  if (currentFrameValid_ && currentFrame_[2] < nbKeyFrames &&
+      currentFrame_[1] != currentFrame_[2] &&
+      keyFrame_[currentFrame_[1]].time() <= time &&
+      time < keyFrame_[currentFrame_[2]].time())
+    // Still in the same segment, the usual case during an interpolation
+    return;
 
+  // First keyFrame whose time is not less than time
+  const int next = int(std::lower_bound(keyFrame_.begin(), keyFrame_.end(), time,
+                                        [](const KeyFrame &kf, qreal t) {
+                                          return kf.time() < t;
+                                        }) -
+                       keyFrame_.begin());
+  const int current2 = std::min(next, nbKeyFrames - 1);
+  const int current1 =
+      (current2 > 0 && time < keyFrame_[current2].time()) ? current2 - 1
+                                                          : current2;
+
+  if (!currentFrameValid_ || current1 != currentFrame_[1] ||
+      current2 != currentFrame_[2]) {
+    currentFrame_[0] = std::max(current1 - 1, 0);
+    currentFrame_[1] = current1;
+    currentFrame_[2] = current2;
+    currentFrame_[3] = std::min(current2 + 1, nbKeyFrames - 1);
     currentFrameValid_ = true;
     splineCacheIsValid_ = false;
   }
-
-  // cout << "Time = " << time << " : " << currentFrame_[0]->peekNext()->time()
-  // << " , " << currentFrame_[1]->peekNext()->time() << " , " <<
-  // currentFrame_[2]->peekNext()->time() << " , " <<
-  // currentFrame_[3]->peekNext()->time() << endl;
 }
 
 void KeyFrameInterpolator::updateSplineCache() {
-  Vec delta = (*std::next(currentFrame_[2]))->position() -
-              (*std::next(currentFrame_[1]))->position();
-  v1 = 3.0 * delta - 2.0 * std::next(*currentFrame_[1])->tgP() -
-       std::next(*currentFrame_[2])->tgP();
-  v2 = -2.0 * delta + std::next(*currentFrame_[1])->tgP() +
-       std::next(*currentFrame_[2])->tgP();
+  const KeyFrame &kf1 = keyFrame_[currentFrame_[1]];
+  const KeyFrame &kf2 = keyFrame_[currentFrame_[2]];
+  Vec delta = kf2.position() - kf1.position();
+  v1 = 3.0 * delta - 2.0 * kf1.tgP() - kf2.tgP();
+  v2 = -2.0 * delta + kf1.tgP() + kf2.tgP();
   splineCacheIsValid_ = true;
 }
 
@@ -544,6 +533,47 @@ void KeyFrameInterpolator::interpolateAtTime(qreal time) {
   if ((keyFrame_.empty()) || (!frame()))
     return;
 
+  Vec pos;
+  Quaternion q;
+  if ((samplesPerSecond() > 0.0) && (duration() > 0.0)) {
+    if (!bakedIsValid_)
+      bake();
+    lookUp(time, pos, q);
+  } else
+    evaluate(time, pos, q);
+  frame()->setPositionAndOrientationWithConstraint(pos, q);
+
+  interpolated.emit();
+}
+
+/*! Sets the samplesPerSecond() of the baked path. The path is sampled at this
+ rate from firstTime() to lastTime() (with at least two samples), and
+ interpolateAtTime() then simply interpolates between the two nearest samples.
+
+ The path is baked again by the first interpolateAtTime() after a
+ modification of the keyFrames. A value of 0.0 (default) disables the baking:
+ the spline is evaluated at each interpolateAtTime(). */
+void KeyFrameInterpolator::setSamplesPerSecond(qreal samplesPerSecond) {
+  samplesPerSecond_ = samplesPerSecond > 0.0 ? samplesPerSecond : 0.0;
+  bakedIsValid_ = false;
+}
+
+/*! Sets the arcLengthParameterization() of the baked path.
+
+ The samples are then evenly spaced along the path, and the interpolationTime()
+ is mapped linearly from [firstTime(), lastTime()] to the path length: the
+ frame() moves at constant speed, the keyFrames orientations and positions
+ being reached at different times than their keyFrameTime().
+
+ Has no effect when samplesPerSecond() is 0.0. */
+void KeyFrameInterpolator::setArcLengthParameterization(bool arcLength) {
+  arcLengthParameterization_ = arcLength;
+  bakedIsValid_ = false;
+}
+
+/*! Evaluates the spline at \p time, clamped to [firstTime(), lastTime()]. */
+void KeyFrameInterpolator::evaluate(qreal time, Vec &position,
+                                    Quaternion &orientation) {
   if (!valuesAreValid_)
     updateModifiedFrameValues();
 
@@ -552,26 +582,84 @@ void KeyFrameInterpolator::interpolateAtTime(qreal time) {
   if (!splineCacheIsValid_)
     updateSplineCache();
 
+  const KeyFrame &kf1 = keyFrame_[currentFrame_[1]];
+  const KeyFrame &kf2 = keyFrame_[currentFrame_[2]];
   qreal alpha;
-  qreal dt = (*std::next(currentFrame_[2]))->time() - (*std::next(currentFrame_[1]))->time();
+  qreal dt = kf2.time() - kf1.time();
   if (dt == 0.0)
     alpha = 0.0;
   else
-    alpha = (time - (*std::next(currentFrame_[1]))->time()) / dt;
+    alpha = (time - kf1.time()) / dt;
 
   // Linear interpolation - debug
-  // Vec pos = alpha*(currentFrame_[2]->peekNext()->position()) +
-  // (1.0-alpha)*(currentFrame_[1]->peekNext()->position());
-  Vec pos =
-      (*std::next(currentFrame_[1]))->position() +
-      alpha * ((*std::next(currentFrame_[1]))->tgP() + alpha * (v1 + alpha * v2));
-  Quaternion q = Quaternion::squad(
-      (*std::next(currentFrame_[1]))->orientation(),
-      (*std::next(currentFrame_[1]))->tgQ(), (*std::next(currentFrame_[2]))->tgQ(),
-      (*std::next(currentFrame_[2]))->orientation(), alpha);
-  frame()->setPositionAndOrientationWithConstraint(pos, q);
+  // Vec pos = alpha*(kf2.position()) + (1.0-alpha)*(kf1.position());
+  position = kf1.position() + alpha * (kf1.tgP() + alpha * (v1 + alpha * v2));
+  orientation = Quaternion::squad(kf1.orientation(), kf1.tgQ(), kf2.tgQ(),
+                                  kf2.orientation(), alpha);
+}
+
+/*! Samples the path at samplesPerSecond(), from firstTime() to lastTime(). */
+void KeyFrameInterpolator::bake() {
+  const qreal first = firstTime();
+  const qreal d = duration();
+  const int nbSamples =
+      std::max(2, int(std::ceil(d * samplesPerSecond())) + 1);
+  samplePosition_.resize(nbSamples);
+  sampleOrientation_.resize(nbSamples);
+  for (int i = 0; i < nbSamples; ++i)
+    evaluate(first + d * i / (nbSamples - 1), samplePosition_[i],
+             sampleOrientation_[i]);
+
+  if (arcLengthParameterization()) {
+    // Length of the path at each sample
+    std::vector<qreal> length(nbSamples, 0.0);
+    for (int i = 1; i < nbSamples; ++i)
+      length[i] =
+          length[i - 1] + (samplePosition_[i] - samplePosition_[i - 1]).norm();
+
+    // Resample at constant length steps, unless the frame() does not move
+    if (length.back() > 0.0) {
+      std::vector<Vec> position(nbSamples);
+      std::vector<Quaternion> orientation(nbSamples);
+      int j = 0;
+      for (int k = 0; k < nbSamples; ++k) {
+        const qreal target = length.back() * k / (nbSamples - 1);
+        while ((j < nbSamples - 2) && (length[j + 1] < target))
+          ++j;
+        const qreal segment = length[j + 1] - length[j];
+        const qreal f = segment > 0.0 ? (target - length[j]) / segment : 0.0;
+        evaluate(first + d * (j + f) / (nbSamples - 1), position[k],
+                 orientation[k]);
+      }
+      samplePosition_.swap(position);
+      sampleOrientation_.swap(orientation);
+    }
+  }
+
+  // Consecutive samples in the same hemisphere, for lookUp()
+  for (int i = 1; i < nbSamples; ++i)
+    if (Quaternion::dot(sampleOrientation_[i - 1], sampleOrientation_[i]) < 0.0)
+      sampleOrientation_[i].negate();
+
+  bakedIsValid_ = true;
+}
 
-  emit("interpolated");
+/*! Interpolates the two baked samples around \p time: a linear interpolation
+ of the positions and a normalized linear interpolation of the orientations. */
+void KeyFrameInterpolator::lookUp(qreal time, Vec &position,
+                                  Quaternion &orientation) const {
+  const int last = int(samplePosition_.size()) - 1;
+  qreal u = (time - firstTime()) / duration() * last;
+  u = std::min(std::max(u, qreal(0.0)), qreal(last));
+  const int i = std::min(int(u), last - 1);
+  const qreal f = u - i;
+
+  position = (1.0 - f) * samplePosition_[i] + f * samplePosition_[i + 1];
+  const Quaternion &a = sampleOrientation_[i];
+  const Quaternion &b = sampleOrientation_[i + 1];
+  orientation = Quaternion((1.0 - f) * a[0] + f * b[0], (1.0 - f) * a[1] + f * b[1],
+                           (1.0 - f) * a[2] + f * b[2], (1.0 - f) * a[3] + f * b[3]);
+  orientation.normalize();
 }
 
 //////////// KeyFrame private class implementation /////////
@@ -591,10 +679,10 @@ void KeyFrameInterpolator::KeyFrame::updateValuesFromPointer() {
   q_ = frame()->orientation();
 }
 
-void KeyFrameInterpolator::KeyFrame::computeTangent(
-    const KeyFrame *const prev, const KeyFrame *const next) {
-  tgP_ = 0.5 * (next->position() - prev->position());
-  tgQ_ = Quaternion::squadTangent(prev->orientation(), q_, next->orientation());
+void KeyFrameInterpolator::KeyFrame::computeTangent(const KeyFrame &prev,
+                                                    const KeyFrame &next) {
+  tgP_ = 0.5 * (next.position() - prev.position());
+  tgQ_ = Quaternion::squadTangent(prev.orientation(), q_, next.orientation());
 }
 
 void KeyFrameInterpolator::KeyFrame::flipOrientationIfNeeded(
@@ -4,7 +4,7 @@
 #include "quaternion.h"
 // Not actually needed, but some bad compilers (Microsoft VS6) complain.
 #include "frame.h"
-#include <list>
+#include <vector>
 #include "Signaler.h"
 
 // If you compiler complains about incomplete type, uncomment the next line
@@ -85,6 +85,16 @@ class Frame;
   Fx plays/pauses path interpolation. See QGLViewer::pathKey() and the <a
   href="../keyboard.html">keyboard page</a> for details.
 
+  <h3>Baked path</h3>
+
+  interpolateAtTime() evaluates the spline (a Hermite curve for the position
+  and a Quaternion::squad() for the orientation) at each call. With a positive
+  setSamplesPerSecond(), the path is instead sampled once, after each
+  modification, and interpolateAtTime() interpolates between the two nearest
+  samples. setArcLengthParameterization() additionally respaces these samples
+  at constant distance along the path, for a constant speed playback: the
+  keyFrameTime() are then no longer reached at their time.
+
   \attention If a Constraint is attached to the frame() (see
   Frame::constraint()), it should be deactivated before
   interpolationIsStarted(), otherwise the interpolated motion (computed as if
@@ -158,7 +168,7 @@ public:
   qreal keyFrameTime(int index) const;
   /*! Returns the number of keyFrames used by the interpolation. Use
    * addKeyFrame() to add new keyFrames. */
-  int numberOfKeyFrames() const { return keyFrame_.size(); }
+  int numberOfKeyFrames() const { return int(keyFrame_.size()); }
   qreal duration() const;
   qreal firstTime() const;
   qreal lastTime() const;
@@ -201,6 +211,14 @@ public:
 
   In both cases, the endReached() signal is emitted. */
   bool loopInterpolation() const { return loopInterpolation_; }
+  /*! Returns the number of samples per second of the baked path used by
+  interpolateAtTime(). Default value is 0.0: the spline is evaluated at each
+  call. See setSamplesPerSecond(). */
+  qreal samplesPerSecond() const { return samplesPerSecond_; }
+  /*! Returns \c true when the baked path is parameterized by arc length, so
+  that the frame() moves at constant speed along the path. Default value is \c
+  false. See setArcLengthParameterization(). */
+  bool arcLengthParameterization() const { return arcLengthParameterization_; }
 
 public: 
   /*! Sets the interpolationTime().
@@ -216,6 +234,8 @@ public:
   void setInterpolationPeriod(int period) { period_ = period; }
   /*! Sets the loopInterpolation() value. */
   void setLoopInterpolation(bool loop = true) { loopInterpolation_ = loop; }
+  void setSamplesPerSecond(qreal samplesPerSecond);
+  void setArcLengthParameterization(bool arcLength = true);
 
   //@}
 
@@ -247,6 +267,28 @@ public:
   virtual void drawPath(int mask = 1, int nbFrames = 6, qreal scale = 1.0);
   //@}
 
+  /*! @name Signals */
+  //@{
+public:
+  /*! This signal is emitted whenever the frame() state is interpolated.
+
+  The emission of this signal triggers the synchronous emission of the frame()
+  Frame::interpolated() signal, which may also be useful.
+
+  This signal should especially be connected to your QGLViewer::update() slot,
+  so that the display is updated after every update of the KeyFrameInterpolator
+  frame(). Note that the QGLViewer::camera() Camera::keyFrameInterpolator() are
+  connected to their QGLViewer::update() slot. */
+  TypedSignal<> interpolated;
+
+  /*! This signal is emitted when the interpolation reaches the first (when
+  interpolationSpeed() is negative) or the last keyFrame.
+
+  When loopInterpolation() is \c true, interpolationTime() is reset and the
+  interpolation continues. It otherwise stops. */
+  TypedSignal<> endReached;
+  //@}
+
 
 private:
   virtual void update();
@@ -254,19 +296,23 @@ private:
     valuesAreValid_ = false;
     pathIsValid_ = false;
     splineCacheIsValid_ = false;
+    bakedIsValid_ = false;
   }
 
 private:
-  // Copy constructor and opertor= are declared private and undefined
-  // Prevents everyone from trying to use them
-  // KeyFrameInterpolator(const KeyFrameInterpolator& kfi);
-  // KeyFrameInterpolator& operator=(const KeyFrameInterpolator& kfi);
+  // Copy constructor and operator= are deleted: the path buffer, the timer and
+  // the connections to the frame() belong to one interpolator
+  KeyFrameInterpolator(const KeyFrameInterpolator &kfi) = delete;
+  KeyFrameInterpolator &operator=(const KeyFrameInterpolator &kfi) = delete;
 
   void updateCurrentKeyFrameForTime(qreal time);
   void updateModifiedFrameValues();
   void updateSplineCache();
+  void evaluate(qreal time, Vec &position, Quaternion &orientation);
+  void bake();
+  void lookUp(qreal time, Vec &position, Quaternion &orientation) const;
 
-  // Internal private KeyFrame representation
+  // Internal private KeyFrame representation, stored by value
   class KeyFrame {
   public:
     KeyFrame(const Frame &fr, qreal t);
@@ -280,19 +326,34 @@ private:
     const Frame *frame() const { return frame_; }
     void updateValuesFromPointer();
     void flipOrientationIfNeeded(const Quaternion &prev);
-    void computeTangent(const KeyFrame *const prev, const KeyFrame *const next);
+    void computeTangent(const KeyFrame &prev, const KeyFrame &next);
 
   private:
     Vec p_, tgP_;
     Quaternion q_, tgQ_;
     qreal time_;
-    const Frame *const frame_;
+    const Frame *frame_;
   };
 
   // K e y F r a m e s
-  mutable std::list<KeyFrame *> keyFrame_;
-  std::vector<std::list<KeyFrame *>::iterator> currentFrame_;
-  std::list<Frame> path_;
+  std::vector<KeyFrame> keyFrame_;
+  // indices of the keyFrames around the interpolationTime(): the current
+  // segment goes from currentFrame_[1] to currentFrame_[2]
+  int currentFrame_[4];
+  // drawPath() positions and orientations, nbSteps per keyFrame segment
+  std::vector<Vec> pathPosition_;
+  std::vector<Quaternion> pathOrientation_;
+  // pathPosition_, as drawn by drawPath()
+  GLuint pathBuffer_;
+  bool pathBufferIsValid_;
+
+  // B a k e d   p a t h
+  // samples from firstTime() to lastTime(), uniform in time or in arc length
+  qreal samplesPerSecond_;
+  bool arcLengthParameterization_;
+  bool bakedIsValid_;
+  std::vector<Vec> samplePosition_;
+  std::vector<Quaternion> sampleOrientation_;
 
   // A s s o c i a t e d   f r a m e
   Frame *frame_;
@@ -14,7 +14,7 @@ ManipulatedCameraFrame::ManipulatedCameraFrame()
     : driveSpeed_(0.0), sceneUpVector_(0.0, 1.0, 0.0),
       rotatesAroundUpVector_(false), zoomsOnPivotPoint_(false) {
   setFlySpeed(0.0);
-  flyTimer_.connect("timeout", std::bind(&ManipulatedCameraFrame::flyUpdate, this), this);
+  flyTimer_.timeout.connect(std::bind(&ManipulatedCameraFrame::flyUpdate, this), this);
 
 }
 
@@ -36,7 +36,7 @@ operator=(const ManipulatedCameraFrame &mcf) {
 ManipulatedCameraFrame::ManipulatedCameraFrame(
     const ManipulatedCameraFrame &mcf)
     : ManipulatedFrame(mcf) {  
-  flyTimer_.connect("timeout", std::bind(&ManipulatedCameraFrame::flyUpdate, this), this);
+  flyTimer_.timeout.connect(std::bind(&ManipulatedCameraFrame::flyUpdate, this), this);
   (*this) = (mcf);
 }
 
@@ -72,7 +72,7 @@ void ManipulatedCameraFrame::flyUpdate() {
 
   // Needs to be out of the switch since ZOOM/fastDraw()/wheelEvent use this
   // callback to trigger a final draw(). #CONNECTION# wheelEvent.
-  emit("manipulated");
+  manipulated.emit();
 }
 
 /*! This method will be called by the Camera when its orientation is changed, so
@@ -268,7 +268,7 @@ void ManipulatedCameraFrame::mouseMoveEvent(QMouseEvent *const event,
     if (action_ != QGLViewer::ZOOM_ON_REGION)
       // ZOOM_ON_REGION should not emit manipulated().
       // prevPos_ is used to draw rectangle feedback.
-      emit("manipulated");
+      manipulated.emit();
   }
 }
 
@@ -299,7 +299,7 @@ void ManipulatedCameraFrame::wheelEvent(QWheelEvent *const event,
   switch (action_) {
   case QGLViewer::ZOOM: {
     zoom(wheelDelta(event), camera);
-    emit("manipulated");
+    manipulated.emit();
     break;
   }
   case QGLViewer::MOVE_FORWARD:
@@ -307,7 +307,7 @@ void ManipulatedCameraFrame::wheelEvent(QWheelEvent *const event,
     //#CONNECTION# mouseMoveEvent() MOVE_FORWARD case
     translate(
         inverseTransformOf(Vec(0.0, 0.0, 0.2 * flySpeed() * event->angleDelta().y())));
-    emit("manipulated");
+    manipulated.emit();
     break;
   default:
     break;
@@ -8,6 +8,9 @@
 using namespace qglviewer;
 using namespace std;
 
+// checkIfGrabsMouse() region half size, in pixels
+static const int grabThreshold = 10;
+
 /*! Default constructor.
 
   The translation is set to (0,0,0), with an identity rotation (0,0,0,1) (see
@@ -26,8 +29,9 @@ ManipulatedFrame::ManipulatedFrame()
 
   isSpinning_ = false;
   previousConstraint_ = nullptr;
-  addSignal("spun");
-  spinningTimer_.connect("timeout", std::bind(&ManipulatedFrame::spinUpdate, this), this);
+  addSignal("manipulated", manipulated);
+  addSignal("spun", spun);
+  spinningTimer_.timeout.connect(std::bind(&ManipulatedFrame::spinUpdate, this), this);
 
 }
 
@@ -53,6 +57,8 @@ ManipulatedFrame &ManipulatedFrame::operator=(const ManipulatedFrame &mf) {
  */
 ManipulatedFrame::ManipulatedFrame(const ManipulatedFrame &mf)
     : Frame(mf), MouseGrabber()  {
+  addSignal("manipulated", manipulated);
+  addSignal("spun", spun);
   (*this) = mf;
 }
 
@@ -67,10 +73,21 @@ See the <a href="../examples/mouseGrabber.html">mouseGrabber example</a> for an
 illustration. */
 void ManipulatedFrame::checkIfGrabsMouse(int x, int y,
                                          const Camera *const camera) {
-  const int thresold = 10;
   const Vec proj = camera->projectedCoordinatesOf(position());
-  setGrabsMouse(keepsGrabbingMouse_ || ((fabs(x - proj.x) < thresold) &&
-                                        (fabs(y - proj.y) < thresold)));
+  setGrabsMouse(keepsGrabbingMouse_ || ((fabs(x - proj.x) < grabThreshold) &&
+                                        (fabs(y - proj.y) < grabThreshold)));
+}
+
+/*! The region of checkIfGrabsMouse(), around the projected position(). While
+ keepsGrabbingMouse_, the ManipulatedFrame grabsMouse() and is hence always
+ tested by the MouseGrabberIndex. */
+bool ManipulatedFrame::screenRegion(const Camera *const camera, qreal &x,
+                                    qreal &y, qreal &halfSize) const {
+  const Vec proj = camera->projectedCoordinatesOf(position());
+  x = proj.x;
+  y = proj.y;
+  halfSize = grabThreshold;
+  return true;
 }
 
 
@@ -113,7 +130,7 @@ void ManipulatedFrame::spin() { rotate(spinningQuaternion()); }
    special to be done for continuous spinning with this design. */
 void ManipulatedFrame::spinUpdate() {
   spin();
-  emit("spun");
+  spun.emit();
 }
 
 /*! Protected internal method used to handle mouse events. */
@@ -357,7 +374,7 @@ void ManipulatedFrame::mouseMoveEvent(QMouseEvent *const event,
 
   if (action_ != QGLViewer::NO_MOUSE_ACTION) {
     prevPos_ = event->pos();
-    emit("manipulated");
+    manipulated.emit();
   }
 }
 
@@ -414,7 +431,7 @@ void ManipulatedFrame::wheelEvent(QWheelEvent *const event,
   //#CONNECTION# QGLViewer::setWheelBinding
   if (action_ == QGLViewer::ZOOM) {
     zoom(wheelDelta(event), camera);
-    emit("manipulated");
+    manipulated.emit();
   }
 
   // #CONNECTION# startAction should always be called before
@@ -241,10 +241,31 @@ public:
   QGLViewer::MouseAction currentMouseAction() const { return action_; }
   //@}
 
+  /*! @name Signals */
+  //@{
+public:
+  /*! This signal is emitted when ever the ManipulatedFrame is manipulated
+  using the mouse.
+
+  Connect this signal to any object that should be notified. Note that when a
+  ManipulatedFrame is attached to a QGLViewer, this signal is automatically
+  connected to the QGLViewer::update() slot (see
+  QGLViewer::setManipulatedFrame()). */
+  TypedSignal<> manipulated;
+
+  /*! This signal is emitted when the ManipulatedFrame isSpinning().
+
+  Note that for the QGLViewer::manipulatedFrame(), this signal is automatically
+  connected to the QGLViewer::update() slot. */
+  TypedSignal<> spun;
+  //@}
+
   /*! @name MouseGrabber implementation */
   //@{
 public:
   virtual void checkIfGrabsMouse(int x, int y, const Camera *const camera);
+  virtual bool screenRegion(const Camera *const camera, qreal &x, qreal &y,
+                            qreal &halfSize) const;
 
   QPoint prevPos() const {
     return prevPos_;
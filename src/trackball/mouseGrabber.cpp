@@ -4,6 +4,7 @@ using namespace qglviewer;
 
 // Static private variable
 std::list<MouseGrabber *> MouseGrabber::MouseGrabberPool_;
+unsigned int MouseGrabber::poolVersion_ = 0;
 
 /*! Default constructor.
 
@@ -22,8 +23,10 @@ that it is no longer tested with checkIfGrabsMouse() by the QGLViewer, and hence
 can no longer grab mouse focus. Use isInMouseGrabberPool() to know the current
 state of the MouseGrabber. */
 void MouseGrabber::addInMouseGrabberPool() {
-  if (!isInMouseGrabberPool())
+  if (!isInMouseGrabberPool()) {
     MouseGrabber::MouseGrabberPool_.push_back(this);
+    ++poolVersion_;
+  }
 }
 
 /*! Removes the MouseGrabber from the MouseGrabberPool().
@@ -31,8 +34,10 @@ void MouseGrabber::addInMouseGrabberPool() {
 See addInMouseGrabberPool() for details. Removing a MouseGrabber that is not in
 MouseGrabberPool() has no effect. */
 void MouseGrabber::removeFromMouseGrabberPool() {
-  if (isInMouseGrabberPool())
+  if (isInMouseGrabberPool()) {
     MouseGrabber::MouseGrabberPool_.remove(const_cast<MouseGrabber *>(this));
+    ++poolVersion_;
+  }
 }
 
 /*! Clears the MouseGrabberPool().
@@ -52,4 +57,5 @@ void MouseGrabber::clearMouseGrabberPool(bool autoDelete) {
       }
       
   MouseGrabber::MouseGrabberPool_.resize(0);
+  ++poolVersion_;
 }
@@ -114,7 +114,10 @@ public:
   MouseGrabber();
   /*! Virtual destructor. Removes the MouseGrabber from the MouseGrabberPool().
    */
-  virtual ~MouseGrabber() { MouseGrabber::MouseGrabberPool_.remove(this); }
+  virtual ~MouseGrabber() {
+    MouseGrabber::MouseGrabberPool_.remove(this);
+    ++poolVersion_;
+  }
 
   /*! @name Mouse grabbing detection */
   //@{
@@ -152,6 +155,22 @@ public:
   in the <a href="../examples/mouseGrabber.html">mouseGrabber example</a>. */
   virtual void checkIfGrabsMouse(int x, int y, const Camera *const camera) = 0;
 
+  /*! Optionally returns the screen region where checkIfGrabsMouse() may grab
+  the mouse: a square of half size \p halfSize pixels, centered on (\p x, \p
+  y), for the \p camera.
+
+  The QGLViewers use it to only checkIfGrabsMouse() on the MouseGrabbers whose
+  region contains the mouse cursor (see MouseGrabberIndex). The region must
+  only depend on the camera matrices and on Frame positions, or the
+  MouseGrabber must call MouseGrabber::invalidateIndex() when it changes.
+
+  The default implementation returns \c false: the region is unknown and
+  checkIfGrabsMouse() is called on each mouse move. */
+  virtual bool screenRegion(const Camera *const camera, qreal &x, qreal &y,
+                            qreal &halfSize) const {
+    return false;
+  }
+
   /*! Returns \c true when the MouseGrabber grabs the QGLViewer's mouse events.
 
   This flag is set with setGrabsMouse() by the checkIfGrabsMouse() method. */
@@ -191,6 +210,14 @@ public:
   void addInMouseGrabberPool();
   void removeFromMouseGrabberPool();
   void clearMouseGrabberPool(bool autoDelete = false);
+
+  /*! Incremented whenever the MouseGrabberPool() changes, or by
+  invalidateIndex(). See MouseGrabberIndex. */
+  static unsigned int poolVersion() { return poolVersion_; }
+  /*! Forces the MouseGrabberIndex of the QGLViewers to be rebuilt, when a
+  screenRegion() changed for another reason than a Frame or Camera
+  modification. */
+  static void invalidateIndex() { ++poolVersion_; }
   //@}
 
   /*! @name Mouse event handlers */
@@ -259,6 +286,7 @@ private:
 
   // Q G L V i e w e r   p o o l
   static std::list<MouseGrabber *> MouseGrabberPool_;
+  static unsigned int poolVersion_;
 };
 
 } // namespace qglviewer
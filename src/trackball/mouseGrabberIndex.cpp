@@ -0,0 +1,123 @@
+#include "mouseGrabberIndex.h"
+#include "camera.h"
+#include "mouseGrabber.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace qglviewer;
+
+// size of the grid cells, in pixels
+static const int cellSize = 32;
+
+MouseGrabberIndex::MouseGrabberIndex()
+    : columns_(0), rows_(0), camera_(nullptr), poolVersion_(0),
+      frameVersion_(0), cameraVersion_(0), width_(0), height_(0),
+      built_(false) {}
+
+bool MouseGrabberIndex::isUpToDate(const Camera *const camera) const {
+  return built_ && camera == camera_ &&
+         MouseGrabber::poolVersion() == poolVersion_ &&
+         Frame::modificationCount() == frameVersion_ &&
+         camera->modelViewProjectionVersion() == cameraVersion_ &&
+         camera->screenWidth() == width_ && camera->screenHeight() == height_;
+}
+
+void MouseGrabberIndex::rebuild(const Camera *const camera) {
+  // the grabbers that were grabbing, in the new snapshot
+  std::vector<MouseGrabber *> grabbing;
+  for (int i : grabbing_)
+    grabbing.push_back(pool_[i]);
+  grabbing_.clear();
+
+  pool_.assign(MouseGrabber::MouseGrabberPool().begin(),
+               MouseGrabber::MouseGrabberPool().end());
+  unbounded_.clear();
+
+  camera_ = camera;
+  poolVersion_ = MouseGrabber::poolVersion();
+  frameVersion_ = Frame::modificationCount();
+  cameraVersion_ = camera->modelViewProjectionVersion();
+  width_ = camera->screenWidth();
+  height_ = camera->screenHeight();
+  built_ = true;
+
+  columns_ = (width_ + cellSize - 1) / cellSize;
+  rows_ = (height_ + cellSize - 1) / cellSize;
+  const int nbCells = columns_ * rows_;
+
+  // cell ranges [c0, c1] x [r0, r1] of each grabber, -1 if off screen
+  std::vector<int> ranges(4 * pool_.size(), -1);
+  cellStart_.assign(nbCells + 1, 0);
+  for (size_t i = 0; i < pool_.size(); ++i) {
+    if (std::find(grabbing.begin(), grabbing.end(), pool_[i]) != grabbing.end())
+      grabbing_.push_back(int(i));
+
+    qreal x, y, halfSize;
+    if (!pool_[i]->screenRegion(camera, x, y, halfSize)) {
+      unbounded_.push_back(int(i));
+      continue;
+    }
+    if (!(std::isfinite(x) && std::isfinite(y)))
+      continue;
+    const int c0 = std::max(int(std::floor((x - halfSize) / cellSize)), 0);
+    const int c1 = std::min(int(std::floor((x + halfSize) / cellSize)), columns_ - 1);
+    const int r0 = std::max(int(std::floor((y - halfSize) / cellSize)), 0);
+    const int r1 = std::min(int(std::floor((y + halfSize) / cellSize)), rows_ - 1);
+    if (c0 > c1 || r0 > r1)
+      continue;
+    ranges[4 * i] = c0;
+    ranges[4 * i + 1] = c1;
+    ranges[4 * i + 2] = r0;
+    ranges[4 * i + 3] = r1;
+    for (int r = r0; r <= r1; ++r)
+      for (int c = c0; c <= c1; ++c)
+        ++cellStart_[r * columns_ + c + 1];
+  }
+
+  for (int c = 0; c < nbCells; ++c)
+    cellStart_[c + 1] += cellStart_[c];
+  cellGrabbers_.resize(cellStart_[nbCells]);
+
+  // grabbers are added in pool order, each cell stays sorted
+  std::vector<int> fill(cellStart_.begin(), cellStart_.end() - 1);
+  for (size_t i = 0; i < pool_.size(); ++i) {
+    if (ranges[4 * i] < 0)
+      continue;
+    for (int r = ranges[4 * i + 2]; r <= ranges[4 * i + 3]; ++r)
+      for (int c = ranges[4 * i]; c <= ranges[4 * i + 1]; ++c)
+        cellGrabbers_[fill[r * columns_ + c]++] = int(i);
+  }
+}
+
+/*! Returns the MouseGrabbers that may grab the mouse at (\p x, \p y), in the
+ MouseGrabberPool() order. The grid is rebuilt first if needed. Call tested()
+ once checkIfGrabsMouse() was called on them. */
+const std::vector<MouseGrabber *> &
+MouseGrabberIndex::candidates(int x, int y, const Camera *const camera) {
+  if (!isUpToDate(camera))
+    rebuild(camera);
+
+  indices_.assign(unbounded_.begin(), unbounded_.end());
+  indices_.insert(indices_.end(), grabbing_.begin(), grabbing_.end());
+  if (x >= 0 && y >= 0 && x < width_ && y < height_) {
+    const int cell = (y / cellSize) * columns_ + x / cellSize;
+    indices_.insert(indices_.end(), cellGrabbers_.begin() + cellStart_[cell],
+                    cellGrabbers_.begin() + cellStart_[cell + 1]);
+  }
+  std::sort(indices_.begin(), indices_.end());
+  indices_.erase(std::unique(indices_.begin(), indices_.end()), indices_.end());
+
+  candidates_.clear();
+  for (int i : indices_)
+    candidates_.push_back(pool_[i]);
+  return candidates_;
+}
+
+/*! Records which of the last candidates() grab the mouse, so that they are
+ tested again by the next candidates() wherever the mouse goes. */
+void MouseGrabberIndex::tested() {
+  grabbing_.clear();
+  for (size_t i = 0; i < candidates_.size(); ++i)
+    if (candidates_[i]->grabsMouse())
+      grabbing_.push_back(indices_[i]);
+}
@@ -0,0 +1,61 @@
+#ifndef QGLVIEWER_MOUSE_GRABBER_INDEX_H
+#define QGLVIEWER_MOUSE_GRABBER_INDEX_H
+
+#include "config.h"
+#include <vector>
+
+namespace qglviewer {
+class Camera;
+class MouseGrabber;
+
+/*! \brief Screen space grid of the MouseGrabberPool(), used by
+  QGLViewer::mouseMoveEvent().
+  \class MouseGrabberIndex mouseGrabberIndex.h QGLViewer/mouseGrabberIndex.h
+
+  Each MouseGrabber that gives its MouseGrabber::screenRegion() is stored in
+  the cells of a uniform grid of the window that its region overlaps. A mouse
+  move then only calls MouseGrabber::checkIfGrabsMouse() on the MouseGrabbers
+  of the cell under the cursor, on those that have no screenRegion(), and on
+  those that grabbed the mouse at the previous test (so that they can release
+  it). The candidates are returned in the MouseGrabberPool() order, the order
+  in which the whole pool was tested.
+
+  The grid is rebuilt lazily, by the first candidates() call after the
+  MouseGrabberPool(), a Frame (see Frame::modificationCount()), the Camera
+  matrices or the window size changed. */
+class MouseGrabberIndex {
+public:
+  MouseGrabberIndex();
+
+  const std::vector<MouseGrabber *> &candidates(int x, int y,
+                                                const Camera *const camera);
+  void tested();
+
+private:
+  bool isUpToDate(const Camera *const camera) const;
+  void rebuild(const Camera *const camera);
+
+  // snapshot of the MouseGrabberPool(), candidates are indices in it
+  std::vector<MouseGrabber *> pool_;
+  std::vector<int> unbounded_; // no screenRegion(), always tested
+  std::vector<int> grabbing_;  // grabbed the mouse at the last test
+
+  // cells of cellSize pixels, CSR storage: the grabbers of cell c are
+  // cellGrabbers_[cellStart_[c]] to cellGrabbers_[cellStart_[c+1]-1]
+  int columns_, rows_;
+  std::vector<int> cellStart_;
+  std::vector<int> cellGrabbers_;
+
+  std::vector<int> indices_; // of the candidates_
+  std::vector<MouseGrabber *> candidates_;
+
+  // validity of the grid
+  const Camera *camera_;
+  unsigned int poolVersion_, frameVersion_, cameraVersion_;
+  int width_, height_;
+  bool built_;
+};
+
+} // namespace qglviewer
+
+#endif // QGLVIEWER_MOUSE_GRABBER_INDEX_H
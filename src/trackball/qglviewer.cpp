@@ -5,6 +5,7 @@
 #include <format>
 #include <algorithm>
 #include "glUtils.h"
+#include "visualHints.h"
 #include <opengl/glu.h>
 
 using namespace std;
@@ -62,9 +63,9 @@ void QGLViewer::defaultConstructor() {
   mouseGrabberIsAManipulatedFrame_ = false;
   mouseGrabberIsAManipulatedCameraFrame_ = false;
   displayMessage_ = false;
-  messageTimer_.connect("timeout", std::bind(&QGLViewer::hideMessage, this), this);
-  delayedFullScreenTimer_.connect("timeout", std::bind(&QGLViewer::delayedFullScreen, this), this);
-  resetVisualHintsTimer_.connect("timeout", std::bind(&QGLViewer::resetVisualHints, this), this);
+  messageTimer_.timeout.connect(std::bind(&QGLViewer::hideMessage, this), this);
+  delayedFullScreenTimer_.timeout.connect(std::bind(&QGLViewer::delayedFullScreen, this), this);
+  resetVisualHintsTimer_.timeout.connect(std::bind(&QGLViewer::resetVisualHints, this), this);
 
   setMouseGrabber(nullptr);
 
@@ -90,6 +91,7 @@ void QGLViewer::defaultConstructor() {
   setSelectRegionWidth(3);
   setSelectRegionHeight(3);
   setSelectedName(-1);
+  selectionIsAsync_ = false;
 
   bufferTextureId_ = 0;
   bufferTextureMaxU_ = 0.0;
@@ -107,10 +109,28 @@ void QGLViewer::defaultConstructor() {
 
 All viewer parameters (display flags, scene parameters, associated objects...)
 are set to their default values. See the associated documentation. */
-QGLViewer::QGLViewer() : Signaler({"axisIsDrawnChanged", "gridIsDrawnChanged","FPSIsDisplayedChanged", "textIsEnabledChanged", "animateNeeded", "viewerInitialized","helpRequired" }) {
+QGLViewer::QGLViewer() {
+  addSignals();
   defaultConstructor();
 }
 
+/* Registers the typed signals under their names, for the string based
+   Signaler::connect(). */
+void QGLViewer::addSignals() {
+  addSignal("viewerInitialized", viewerInitialized);
+  addSignal("drawNeeded", drawNeeded);
+  addSignal("drawFinished", drawFinished);
+  addSignal("animateNeeded", animateNeeded);
+  addSignal("helpRequired", helpRequired);
+  addSignal("axisIsDrawnChanged", axisIsDrawnChanged);
+  addSignal("gridIsDrawnChanged", gridIsDrawnChanged);
+  addSignal("FPSIsDisplayedChanged", FPSIsDisplayedChanged);
+  addSignal("textIsEnabledChanged", textIsEnabledChanged);
+  addSignal("cameraIsEditedChanged", cameraIsEditedChanged);
+  addSignal("pointSelected", pointSelected);
+  addSignal("mouseGrabberChanged", mouseGrabberChanged);
+}
+
 /*! Virtual destructor.
 
 The viewer is replaced by \c nullptr in the QGLViewerPool() (in order to preserve
@@ -124,7 +144,7 @@ QGLViewer::~QGLViewer() {
 
   delete camera();
   delete[] selectBuffer_;
- 
+  idBuffer_.release();
 }
 
 
@@ -193,6 +213,9 @@ camera in the world coordinate system. \arg draw() (or fastDraw() when the
 camera is manipulated) : main drawing method. Should be overloaded. \arg
 postDraw() : display of visual hints (world axis, FPS...) */
 void QGLViewer::paintGL() {
+    // Completes a selectAsync() and the pointUnderPixel() requests
+    pollSelection();
+    camera()->depthQueries().poll();
 
     // Clears screen, set model view matrix...
     preDraw();
@@ -203,8 +226,13 @@ void QGLViewer::paintGL() {
       draw();
     // Add visual hints: axis, camera, grid...
     postDraw();
-  
-  emit("drawFinished", true);
+
+  // Reads back the depths requested during the frame
+  camera()->depthQueries().flush();
+  if (camera()->depthQueries().isPending())
+    update();
+
+  drawFinished.emit(true);
 }
 
 /*! Sets OpenGL state before draw().
@@ -228,7 +256,7 @@ void QGLViewer::preDraw() {
   // GL_MODELVIEW matrix
   camera()->loadModelViewMatrix();
 
-  emit("drawNeeded");
+  drawNeeded.emit();
 }
 
 
@@ -277,13 +305,23 @@ void QGLViewer::postDraw() {
   // Pivot point, line when camera rolls, zoom region
   drawVisualHints();
 
+  // Grid and axis are drawn in world coordinates, from the cached geometry
+  GLfloat modelView[16], projection[16];
+  camera()->getModelViewMatrix(modelView);
+  camera()->getProjectionMatrix(projection);
+  const float foreground[4] = {
+      foregroundColor().redF(), foregroundColor().greenF(),
+      foregroundColor().blueF(), foregroundColor().alphaF()};
+
   if (gridIsDrawn()) {
     glLineWidth(1.0);
-    drawGrid(camera()->sceneRadius());
+    VisualHints::shared().drawGrid(modelView, projection,
+                                   camera()->sceneRadius(), 10, foreground);
   }
   if (axisIsDrawn()) {
     glLineWidth(2.0);
-    drawAxis(camera()->sceneRadius());
+    VisualHints::shared().drawAxis(modelView, projection,
+                                   camera()->sceneRadius(), foreground);
   }
 
   // FPS computation
@@ -347,7 +385,7 @@ void QGLViewer::setCameraIsEdited(bool edit) {
   } else
     camera()->setZClippingCoefficient(previousCameraZClippingCoefficient_);
 
-  emit("cameraIsEditedChanged", edit);
+  cameraIsEditedChanged.emit(edit);
 
   update();
 }
@@ -488,8 +526,8 @@ void QGLViewer::setCamera(Camera *const camera) {
     return;
 
   // Disconnect current camera from this viewer.
-  this->camera()->frame()->disconnect("manipulated", this);             
-  this->camera()->frame()->disconnect("spun", this);
+  this->camera()->frame()->manipulated.disconnect(this);
+  this->camera()->frame()->spun.disconnect(this);
   //screen()->disconnect("physicalDotsPerInchChanged", this->camera());
   connectAllCameraKFIInterpolatedSignals(false);
 
@@ -501,8 +539,8 @@ void QGLViewer::setCamera(Camera *const camera) {
   //camera->setDevicePixelRatio(screen()->devicePixelRatio());
 
   // Connect camera frame to this viewer.
-  camera->frame()->connect("manipulated", std::bind(&QGLViewer::update, this), this);
-  camera->frame()->connect("spun", std::bind(&QGLViewer::update, this), this);
+  camera->frame()->manipulated.connect(std::bind(&QGLViewer::update, this), this);
+  camera->frame()->spun.connect(std::bind(&QGLViewer::update, this), this);
   //screen()->connect<void, qreal>("physicalDotsPerInchChanged", std::bind(&Camera::setDevicePixelRatio, camera), camera);
   connectAllCameraKFIInterpolatedSignals();
 
@@ -512,15 +550,15 @@ void QGLViewer::setCamera(Camera *const camera) {
 void QGLViewer::connectAllCameraKFIInterpolatedSignals(bool connection) {
   for (auto it = camera()->kfi().begin(), end = camera()->kfi().end() ; it != end ; ++it) {
     if (connection)
-      camera()->keyFrameInterpolator(it->first)->connect("interpolated", std::bind(&QGLViewer::update, this), this);
+      camera()->keyFrameInterpolator(it->first)->interpolated.connect(std::bind(&QGLViewer::update, this), this);
     else
-      camera()->keyFrameInterpolator(it->first)->disconnect("interpolated", this);
+      camera()->keyFrameInterpolator(it->first)->interpolated.disconnect(this);
   }
 
   if (connection)
-    camera()->interpolationKfi()->connect("interpolated", std::bind(&QGLViewer::update, this), this);
+    camera()->interpolationKfi()->interpolated.connect(std::bind(&QGLViewer::update, this), this);
   else
-    camera()->interpolationKfi()->disconnect("interpolated", this);               
+    camera()->interpolationKfi()->interpolated.disconnect(this);
 }
 
 /*! Draws a representation of \p light.
@@ -809,7 +847,7 @@ This method is called when you use the QGLViewer::SELECT mouse binding(s)
 (default is Shift + left button). Use setMouseBinding() to change this. */
 void QGLViewer::select(const QMouseEvent *event) {
   // For those who don't derive but rather rely on the signal-slot mechanism.
-  emit("pointSelected", event);
+  pointSelected.emit(event);
   select(event->pos());
 }
 
@@ -829,46 +867,28 @@ postSelection(point);
 The default implementation of these methods is as follows (see the methods'
 documentation for more details):
 
-\arg beginSelection() sets the \c GL_SELECT mode with the appropriate picking
-matrices. A rectangular frustum (of size defined by selectRegionWidth() and
-selectRegionHeight()) centered on \p point is created.
+\arg beginSelection() binds the idBuffer(), an offscreen framebuffer that covers
+a region (of size defined by selectRegionWidth() and selectRegionHeight())
+centered on \p point, with a projection restricted to this region.
 
 \arg drawWithNames() is empty and should be overloaded. It draws each selectable
-object of the scene, enclosed by calls to \c glPushName() / \c glPopName() to
-tag the object with an integer id.
+object of the scene, enclosed by calls to pushName() / popName() to tag the
+object with an integer id.
 
-\arg endSelection() then restores \c GL_RENDER mode and analyzes the
-selectBuffer() to set in selectedName() the id of the object that was drawn in
-the region. If several object are in the region, the closest one in the depth
-buffer is chosen. If no object has been drawn under cursor, selectedName() is
-set to -1.
+\arg endSelection() reads the ids back and sets in selectedName() the id of the
+closest object drawn in the region (-1 if none), and in selectedNames() the
+ids of all the objects visible in the region.
 
 \arg postSelection() is empty and can be overloaded for possible
 signal/display/interface update.
 
-See the \c glSelectBuffer() man page for details on this \c GL_SELECT mechanism.
-
-This default implementation is quite limited: only the closer object is
-selected, and only one level of names can be pushed. However, this reveals
-sufficient in many cases and you usually only have to overload drawWithNames()
-to implement a simple object selection process. See the <a
-href="../examples/select.html">select example</a> for an illustration.
-
-If you need a more complex selection process (such as a point, edge or triangle
-selection, which is easier with a 2 or 3 levels selectBuffer() heap, and which
-requires a finer depth sorting to privilege point over edge and edges over
-triangles), overload the endSelection() method. Use setSelectRegionWidth(),
-setSelectRegionHeight() and setSelectBufferSize() to tune the select buffer
-configuration. See the <a href="../examples/multiSelect.html">multiSelect
-example</a> for an illustration.
+endSelection() waits for the GPU. Use selectAsync() instead to get the result a
+frame later without stalling, or select(const QRect &) for a rectangular
+multi-selection.
 
 \p point is the center pixel (origin in the upper left corner) of the selection
 region. Use qglviewer::Camera::convertClickToLine() to transform these
-coordinates in a 3D ray if you want to perform an analytical intersection.
-
-\attention \c GL_SELECT mode seems to report wrong results when used in
-conjunction with backface culling. If you encounter problems try to \c
-glDisable(GL_CULL_FACE). */
+coordinates in a 3D ray if you want to perform an analytical intersection. */
 void QGLViewer::select(const QPoint &point) {
   beginSelection(point);
   drawWithNames();
@@ -876,110 +896,140 @@ void QGLViewer::select(const QPoint &point) {
   postSelection(point);
 }
 
+/*! Selects the objects drawn in the rectangle defined by \p corner1 and \p
+corner2 (pixel coordinates, origin in the upper left corner).
+
+selectedNames() lists the ids of all the objects visible in the rectangle, and
+selectedName() is the closest one. Objects fully hidden by other objects are
+not listed. The selectRegionWidth() and selectRegionHeight() are preserved. */
+void QGLViewer::select(const QPoint &corner1, const QPoint &corner2) {
+  const QRect rectangle(corner1, corner2);
+  const int width = selectRegionWidth();
+  const int height = selectRegionHeight();
+  setSelectRegionWidth(rectangle.width());
+  setSelectRegionHeight(rectangle.height());
+  select(rectangle.center());
+  setSelectRegionWidth(width);
+  setSelectRegionHeight(height);
+}
+
+/*! Same as select(), without waiting for the GPU.
+
+beginSelection() and drawWithNames() are called right away, but the read back
+of the ids completes in the background: paintGL() polls it and, once
+available, sets selectedName() and selectedNames() and calls postSelection().
+isSelectionPending() is true in the meantime. A new selection drops the
+pending one.
+
+endSelection() is not called, its overloads should be used with select(). */
+void QGLViewer::selectAsync(const QPoint &point) {
+  beginSelection(point);
+  drawWithNames();
+  idBuffer_.end();
+  nameStack_.clear();
+  selectionIsAsync_ = true;
+  pendingSelection_ = point;
+  update();
+}
+
+/*! Called by paintGL(), completes a selectAsync() once the GPU is done. */
+void QGLViewer::pollSelection() {
+  if (!idBuffer_.isPending() || !selectionIsAsync_)
+    return;
+  int closest;
+  if (idBuffer_.result(closest, selectedNames_, false)) {
+    setSelectedName(closest);
+    postSelection(pendingSelection_);
+  } else
+    update();
+}
+
 /*! This method should prepare the selection. It is called by select() before
 drawWithNames().
 
-The default implementation uses the \c GL_SELECT mode to perform a selection. It
-uses selectBuffer() and selectBufferSize() to define a \c glSelectBuffer(). The
-\c GL_PROJECTION is then set using \c gluPickMatrix(), with a window selection
-size defined by selectRegionWidth() and selectRegionHeight(). Finally, the \c
-GL_MODELVIEW matrix is set to the world coordinate system using
-qglviewer::Camera::loadModelViewMatrix(). See the gluPickMatrix() documentation
-for details.
-
-You should not need to redefine this method (if you use the \c GL_SELECT mode to
-perform your selection), since this code is fairly classical and can be tuned.
-You are more likely to overload endSelection() if you want to use a more complex
-select buffer structure. */
+The default implementation binds the idBuffer(), of selectRegionWidth() x
+selectRegionHeight() pixels, with a projection restricted to this region
+around \p point (the \c gluPickMatrix() frustum) times the camera projection,
+and the camera modelview matrix. The name stack is emptied.
+
+Draws in drawWithNames() use the id program of the idBuffer(), which only needs
+positions in attribute 0. In a compatibility context, the fixed function
+modelview is used: \c glPushMatrix() and \c glMultMatrix() place the objects as
+with \c GL_SELECT. In a core profile, set your own transformations with
+idBuffer().setModelView(). */
 void QGLViewer::beginSelection(const QPoint &point) {
+  selectionIsAsync_ = false;
+  nameStack_.clear();
+
+  // gluPickMatrix(), in OpenGL window coordinates (origin in the lower left
+  // corner)
+  const GLfloat width = GLfloat(selectRegionWidth());
+  const GLfloat height = GLfloat(selectRegionHeight());
+  const GLfloat x = GLfloat(point.x());
+  const GLfloat y = GLfloat(camera()->screenHeight() - point.y());
+  const GLfloat screenWidth = GLfloat(camera()->screenWidth());
+  const GLfloat screenHeight = GLfloat(camera()->screenHeight());
+  GLfloat pick[16] = {0};
+  pick[0] = screenWidth / width;
+  pick[5] = screenHeight / height;
+  pick[10] = 1.0f;
+  pick[12] = (screenWidth - 2.0f * x) / width;
+  pick[13] = (screenHeight - 2.0f * y) / height;
+  pick[15] = 1.0f;
+
+  GLfloat projection[16], modelView[16], m[16];
+  camera()->getProjectionMatrix(projection);
+  camera()->getModelViewMatrix(modelView);
+  for (int c = 0; c < 4; ++c)
+    for (int r = 0; r < 4; ++r) {
+      m[c * 4 + r] = 0.0f;
+      for (int k = 0; k < 4; ++k)
+        m[c * 4 + r] += pick[k * 4 + r] * projection[c * 4 + k];
+    }
 
-  // Prepare the selection mode
-  glSelectBuffer(selectBufferSize(), selectBuffer());
-  glRenderMode(GL_SELECT);
-  glInitNames();
+  idBuffer_.begin(selectRegionWidth(), selectRegionHeight(), m, modelView);
+}
 
-  // Loads the matrices
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
-  static GLint viewport[4];
-  camera()->getViewport(viewport);
-  gluPickMatrix(point.x(), point.y(), selectRegionWidth(), selectRegionHeight(),
-                viewport);
-
-  // loadProjectionMatrix() first resets the GL_PROJECTION matrix with a
-  // glLoadIdentity(). The false parameter prevents this and hence multiplies
-  // the matrices.
-  camera()->loadProjectionMatrix(false);
-  // Reset the original (world coordinates) modelview matrix
-  camera()->loadModelViewMatrix();
+/*! Pushes \p id on the name stack: the next draws of drawWithNames() are tagged
+with this id, until the matching popName().
+
+Only the top of the stack is recorded in the idBuffer(). This replaces \c
+glPushName() and \c glLoadName(), which do nothing outside of the \c GL_SELECT
+render mode: drawWithNames() overloads that use them select nothing and have
+to call pushName() / popName() instead. */
+void QGLViewer::pushName(int id) {
+  nameStack_.push_back(id);
+  idBuffer_.setName(id);
+}
+
+/*! Pops the name stack. See pushName(). */
+void QGLViewer::popName() {
+  if (!nameStack_.empty())
+    nameStack_.pop_back();
+  idBuffer_.setName(nameStack_.empty() ? -1 : nameStack_.back());
 }
 
 /*! This method is called by select() after scene elements were drawn by
 drawWithNames(). It should analyze the selection result to determine which
 object is actually selected.
 
-The default implementation relies on \c GL_SELECT mode (see beginSelection()).
-It assumes that names were pushed and popped in drawWithNames(), and analyzes
-the selectBuffer() to find the name that corresponds to the closer (z min)
-object. It then setSelectedName() to this value, or to -1 if the selectBuffer()
-is empty (no object drawn in selection region). Use selectedName() (probably in
-the postSelection() method) to retrieve this value and update your data
-structure accordingly.
-
-This default implementation, although sufficient for many cases is however
-limited and you may have to overload this method. This will be the case if
-drawWithNames() uses several push levels in the name heap. A more precise depth
-selection, for instance privileging points over edges and triangles to avoid z
-precision problems, will also require an overloading. A typical implementation
-will look like:
-\code
-glFlush();
+The default implementation reads the idBuffer() back, waiting for the GPU, and
+setSelectedName() to the name of the closest (z min) pixel of the region, or to
+-1 if no object was drawn in it. selectedNames() lists the names of all the
+objects visible in the region. Use selectedName() (probably in the
+postSelection() method) to retrieve this value and update your data structure
+accordingly.
 
-// Get the number of objects that were seen through the pick matrix frustum.
-// Resets GL_RENDER mode.
-GLint nbHits = glRenderMode(GL_RENDER);
+You may overload this method to pick differently, from the read back of
+idBuffer().result(). */
+void QGLViewer::endSelection(const QPoint &point) {
+  idBuffer_.end();
+  nameStack_.clear();
 
-if (nbHits <= 0)
-setSelectedName(-1);
-else
-{
-// Interpret results: each object created values in the selectBuffer().
-// See the glSelectBuffer() man page for details on the buffer structure.
-// The following code depends on your selectBuffer() structure.
-for (int i=0; i<nbHits; ++i)
-if ((selectBuffer())[i*4+1] < zMin)
-setSelectedName((selectBuffer())[i*4+3])
-}
-\endcode
-
-See the <a href="../examples/multiSelect.html">multiSelect example</a> for
-a multi-object selection implementation of this method. */
-void QGLViewer::endSelection(const QPoint &point) {  
-
-  // Flush GL buffers
-  glFlush();
-
-  // Get the number of objects that were seen through the pick matrix frustum.
-  // Reset GL_RENDER mode.
-  GLint nbHits = glRenderMode(GL_RENDER);
-
-  if (nbHits <= 0)
-    setSelectedName(-1);
-  else {
-    // Interpret results: each object created 4 values in the selectBuffer().
-    // selectBuffer[4*i+1] is the object minimum depth value, while
-    // selectBuffer[4*i+3] is the id pushed on the stack. Of all the objects
-    // that were projected in the pick region, we select the closest one (zMin
-    // comparison). This code needs to be modified if you use several stack
-    // levels. See glSelectBuffer() man page.
-    GLuint zMin = (selectBuffer())[1];
-    setSelectedName(int((selectBuffer())[3]));
-    for (int i = 1; i < nbHits; ++i)
-      if ((selectBuffer())[4 * i + 1] < zMin) {
-        zMin = (selectBuffer())[4 * i + 1];
-        setSelectedName(int((selectBuffer())[4 * i + 3]));
-      }
-  }
+  int closest = -1;
+  if (!idBuffer_.result(closest, selectedNames_, true))
+    selectedNames_.clear();
+  setSelectedName(closest);
 }
 
 /*! Sets the selectBufferSize().
@@ -1022,7 +1072,11 @@ void QGLViewer::performClickAction(ClickAction ca, const QMouseEvent *const e) {
   case NO_CLICK_ACTION:
     break;
   case ZOOM_ON_PIXEL:
-    camera()->interpolateToZoomOnPixel(e->pos());
+    camera()->pointUnderPixel(e->pos(), [this](const Vec &target, bool found) {
+      if (found)
+        camera()->interpolateToZoomOnPoint(target);
+    });
+    update();
     break;
   case ZOOM_TO_FIT:
     camera()->interpolateToFitScene();
@@ -1032,9 +1086,11 @@ void QGLViewer::performClickAction(ClickAction ca, const QMouseEvent *const e) {
     update();
     break;
   case RAP_FROM_PIXEL:
-    if (!camera()->setPivotPointFromPixel(e->pos()))
-      camera()->setPivotPoint(sceneCenter());
-    setVisualHintsMask(1);
+    camera()->pointUnderPixel(e->pos(), [this](const Vec &point, bool found) {
+      camera()->setPivotPoint(found ? point : sceneCenter());
+      setVisualHintsMask(1);
+      update();
+    });
     update();
     break;
   case RAP_IS_CENTER:
@@ -1209,17 +1265,21 @@ void QGLViewer::mouseMoveEvent(QMouseEvent *e) {
       else
         manipulatedFrame()->mouseMoveEvent(e, camera());
     else if (hasMouseTracking()) {
-      for(auto mgit = MouseGrabber::MouseGrabberPool().begin()  ; mgit !=  MouseGrabber::MouseGrabberPool().end() ; ++mgit) {
-        (*mgit)->checkIfGrabsMouse(e->x(), e->y(), camera());
-        if ((*mgit)->grabsMouse()) {
-          setMouseGrabber(*mgit);
+      // Only the MouseGrabbers whose screen region contains the cursor
+      const std::vector<MouseGrabber *> &candidates =
+          mouseGrabberIndex_.candidates(e->x(), e->y(), camera());
+      for (MouseGrabber *mg : candidates) {
+        mg->checkIfGrabsMouse(e->x(), e->y(), camera());
+        if (mg->grabsMouse()) {
+          setMouseGrabber(mg);
           // Check that MouseGrabber is not disabled
-          if (mouseGrabber() == *mgit) {
+          if (mouseGrabber() == mg) {
             update();
             break;
           }
         }
       }
+      mouseGrabberIndex_.tested();
     }
   }
 }
@@ -1373,7 +1433,7 @@ void QGLViewer::setMouseGrabber(MouseGrabber *mouseGrabber) {
   mouseGrabberIsAManipulatedCameraFrame_ =
       ((dynamic_cast<ManipulatedCameraFrame *>(mouseGrabber) != nullptr) &&
        (mouseGrabber != camera()->frame()));
-  emit("mouseGrabberChanged", mouseGrabber);
+  mouseGrabberChanged.emit(mouseGrabber);
 }
 
 /*! Sets the mouseGrabberIsEnabled() state. */
@@ -1864,7 +1924,7 @@ change layout...).
 
 The helpRequired() signal is emitted. */
 void QGLViewer::help() {
-  emit("helpRequired");
+  helpRequired.emit();
 
   //bool resize = false;
   //int width = 600;
@@ -1996,7 +2056,7 @@ void QGLViewer::keyPressEvent(QKeyEvent *e) {
       int elapsed = doublePress.restart();
       if ((elapsed < 250) && (index == previousPathId_)) {
         if (camera()->keyFrameInterpolator(index)) {
-          camera()->keyFrameInterpolator(index)->disconnect("interpolated", this);
+          camera()->keyFrameInterpolator(index)->interpolated.disconnect(this);
           if (camera()->keyFrameInterpolator(index)->numberOfKeyFrames() > 1)
             displayMessage(std::format("Path {0} deleted",index));
           else
@@ -2007,7 +2067,7 @@ void QGLViewer::keyPressEvent(QKeyEvent *e) {
         bool nullBefore = (camera()->keyFrameInterpolator(index) == nullptr);
         camera()->addKeyFrameToPath(index);
         if (nullBefore)
-          camera()->keyFrameInterpolator(index)->connect("interpolated", std::bind(&QGLViewer::update, this), this);
+          camera()->keyFrameInterpolator(index)->interpolated.connect(std::bind(&QGLViewer::update, this), this);
         int nbKF = camera()->keyFrameInterpolator(index)->numberOfKeyFrames();
         if (nbKF > 1)
           displayMessage(std::format("Path {0}, position {1} added", index, nbKF));
@@ -3044,8 +3104,8 @@ void QGLViewer::setManipulatedFrame(ManipulatedFrame *frame) {
     manipulatedFrame()->stopSpinning();
 
     if (manipulatedFrame() != camera()->frame()) {
-      manipulatedFrame()->disconnect("manipulated", this);
-      manipulatedFrame()->disconnect("spun", this);
+      manipulatedFrame()->manipulated.disconnect(this);
+      manipulatedFrame()->spun.disconnect(this);
     }
   }
 
@@ -3059,8 +3119,8 @@ void QGLViewer::setManipulatedFrame(ManipulatedFrame *frame) {
     // Prevent multiple connections, that would result in useless display
     // updates
     if (manipulatedFrame() != camera()->frame()) {
-      manipulatedFrame()->connect("manipulated", std::bind(&QGLViewer::update, this), this);
-      manipulatedFrame()->connect("spun", std::bind(&QGLViewer::update, this), this);
+      manipulatedFrame()->manipulated.connect(std::bind(&QGLViewer::update, this), this);
+      manipulatedFrame()->spun.connect(std::bind(&QGLViewer::update, this), this);
     }
   }
 }
@@ -3174,6 +3234,21 @@ void QGLViewer::resetVisualHints() { visualHint_ = 0; }
 //       A x i s   a n d   G r i d   d i s p l a y   l i s t s                //
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+// Current fixed function matrices and color, used by the static display
+// methods. A core profile has none: use VisualHints with explicit matrices.
+struct CurrentState {
+  GLfloat modelView[16];
+  GLfloat projection[16];
+  GLfloat color[4];
+  CurrentState() {
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_CURRENT_COLOR, color);
+  }
+};
+} // namespace
+
 /*! Draws a 3D arrow along the positive Z axis.
 
 \p length, \p radius and \p nbSubdivisions define its geometry. If \p radius is
@@ -3182,22 +3257,13 @@ negative (default), it is set to 0.05 * \p length.
 Use drawArrow(const Vec& from, const Vec& to, qreal radius, int nbSubdivisions)
 or change the \c ModelView matrix to place the arrow in 3D.
 
-Uses current color and does not modify the OpenGL state. */
+The arrow geometry is built once per radius / length ratio and \p
+nbSubdivisions, see VisualHints. Uses current color and matrices and does not
+modify the OpenGL state. */
 void QGLViewer::drawArrow(qreal length, qreal radius, int nbSubdivisions) {
-  static GLUquadric *quadric = gluNewQuadric();
-
-  if (radius < 0.0)
-    radius = 0.05 * length;
-
-  const qreal head = 2.5 * (radius / length) + 0.1;
-  const qreal coneRadiusCoef = 4.0 - 5.0 * head;
-
-  gluCylinder(quadric, radius, radius, length * (1.0 - head / coneRadiusCoef),
-              nbSubdivisions, 1);
-  glTranslated(0.0, 0.0, length * (1.0 - head));
-  gluCylinder(quadric, coneRadiusCoef * radius, 0.0, head * length,
-              nbSubdivisions, 1);
-  glTranslated(0.0, 0.0, -length * (1.0 - head));
+  CurrentState state;
+  VisualHints::shared().drawArrow(state.modelView, state.projection, length,
+                                  radius, nbSubdivisions, state.color);
 }
 
 /*! Draws a 3D arrow between the 3D point \p from and the 3D point \p to, both
@@ -3230,76 +3296,13 @@ The current color and line width are used to draw the X, Y and Z characters at
 the extremities of the three arrows. The OpenGL state is not modified by this
 method.
 
-axisIsDrawn() uses this method to draw a representation of the world coordinate
-system. See also QGLViewer::drawArrow() and QGLViewer::drawGrid(). */
+axisIsDrawn() uses VisualHints::drawAxis() to draw a representation of the
+world coordinate system. See also QGLViewer::drawArrow() and
+QGLViewer::drawGrid(). */
 void QGLViewer::drawAxis(qreal length) {
-  const qreal charWidth = length / 40.0;
-  const qreal charHeight = length / 30.0;
-  const qreal charShift = 1.04 * length;
-
-  GLboolean lighting, colorMaterial;
-  glGetBooleanv(GL_LIGHTING, &lighting);
-  glGetBooleanv(GL_COLOR_MATERIAL, &colorMaterial);
-
-  glDisable(GL_LIGHTING);
-
-  glBegin(GL_LINES);
-  // The X
-  glVertex3d(charShift, charWidth, -charHeight);
-  glVertex3d(charShift, -charWidth, charHeight);
-  glVertex3d(charShift, -charWidth, -charHeight);
-  glVertex3d(charShift, charWidth, charHeight);
-  // The Y
-  glVertex3d(charWidth, charShift, charHeight);
-  glVertex3d(0.0, charShift, 0.0);
-  glVertex3d(-charWidth, charShift, charHeight);
-  glVertex3d(0.0, charShift, 0.0);
-  glVertex3d(0.0, charShift, 0.0);
-  glVertex3d(0.0, charShift, -charHeight);
-  // The Z
-  glVertex3d(-charWidth, charHeight, charShift);
-  glVertex3d(charWidth, charHeight, charShift);
-  glVertex3d(charWidth, charHeight, charShift);
-  glVertex3d(-charWidth, -charHeight, charShift);
-  glVertex3d(-charWidth, -charHeight, charShift);
-  glVertex3d(charWidth, -charHeight, charShift);
-  glEnd();
-
-  glEnable(GL_LIGHTING);
-  glDisable(GL_COLOR_MATERIAL);
-
-  float color[4];
-  color[0] = 0.7f;
-  color[1] = 0.7f;
-  color[2] = 1.0f;
-  color[3] = 1.0f;
-  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, color);
-  QGLViewer::drawArrow(length, 0.01 * length);
-
-  color[0] = 1.0f;
-  color[1] = 0.7f;
-  color[2] = 0.7f;
-  color[3] = 1.0f;
-  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, color);
-  glPushMatrix();
-  glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-  QGLViewer::drawArrow(length, 0.01 * length);
-  glPopMatrix();
-
-  color[0] = 0.7f;
-  color[1] = 1.0f;
-  color[2] = 0.7f;
-  color[3] = 1.0f;
-  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, color);
-  glPushMatrix();
-  glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-  QGLViewer::drawArrow(length, 0.01 * length);
-  glPopMatrix();
-
-  if (colorMaterial)
-    glEnable(GL_COLOR_MATERIAL);
-  if (!lighting)
-    glDisable(GL_LIGHTING);
+  CurrentState state;
+  VisualHints::shared().drawAxis(state.modelView, state.projection, length,
+                                 state.color);
 }
 
 /*! Draws a grid in the XY plane, centered on (0,0,0) (defined in the current
@@ -3311,23 +3314,9 @@ drawAxis() documentation).
 
 The OpenGL state is not modified by this method. */
 void QGLViewer::drawGrid(qreal size, int nbSubdivisions) {
-  GLboolean lighting;
-  glGetBooleanv(GL_LIGHTING, &lighting);
-
-  glDisable(GL_LIGHTING);
-
-  glBegin(GL_LINES);
-  for (int i = 0; i <= nbSubdivisions; ++i) {
-    const qreal pos = size * (2.0 * i / nbSubdivisions - 1.0);
-    glVertex2d(pos, -size);
-    glVertex2d(pos, +size);
-    glVertex2d(-size, pos);
-    glVertex2d(size, pos);
-  }
-  glEnd();
-
-  if (lighting)
-    glEnable(GL_LIGHTING);
+  CurrentState state;
+  VisualHints::shared().drawGrid(state.modelView, state.projection, size,
+                                 nbSubdivisions, state.color);
 }
 
 
@@ -2,6 +2,8 @@
 #define QGLVIEWER_QGLVIEWER_H
 
 #include "camera.h"
+#include "idBuffer.h"
+#include "mouseGrabberIndex.h"
 #include <GLFW/glfw3.h>
 #include "Signaler.h"
 
@@ -86,28 +88,28 @@ public:
    * See also toggleAxisIsDrawn(). */
   void setAxisIsDrawn(bool draw = true) {
     axisIsDrawn_ = draw;
-    emit<bool>("axisIsDrawnChanged", draw);
+    axisIsDrawnChanged.emit(draw);
     update();
   }
   /*! Sets the state of gridIsDrawn(). Emits the gridIsDrawnChanged() signal.
    * See also toggleGridIsDrawn(). */
   void setGridIsDrawn(bool draw = true) {
     gridIsDrawn_ = draw;
-    emit<bool>("gridIsDrawnChanged", draw);
+    gridIsDrawnChanged.emit(draw);
     update();
   }
   /*! Sets the state of FPSIsDisplayed(). Emits the FPSIsDisplayedChanged()
    * signal. See also toggleFPSIsDisplayed(). */
   void setFPSIsDisplayed(bool display = true) {
     FPSIsDisplayed_ = display;
-    emit<bool>("FPSIsDisplayedChanged", display);
+    FPSIsDisplayedChanged.emit(display);
     update();
   }
   /*! Sets the state of textIsEnabled(). Emits the textIsEnabledChanged()
    * signal. See also toggleTextIsEnabled(). */
   void setTextIsEnabled(bool enable = true) {
     textIsEnabled_ = enable;
-    emit<bool>("textIsEnabledChanged",enable);
+    textIsEnabledChanged.emit(enable);
     update();
   }
   void setCameraIsEdited(bool edit = true);
@@ -529,7 +531,7 @@ public:
     See the <a href="../examples/animation.html">animation example</a> for an
     illustration. */
   virtual void animate() { 
-    emit("animateNeeded"); 
+    animateNeeded.emit();
   }
   /*! Calls startAnimation() or stopAnimation(), depending on
    * animationIsStarted(). */
@@ -547,13 +549,13 @@ public:
 
   Connect this signal to the methods that need to be called to initialize your
   viewer or overload init(). */
-  void viewerInitialized();
+  TypedSignal<> viewerInitialized;
 
   /*! Signal emitted by the default draw() method.
 
   Connect this signal to your main drawing method or overload draw(). See the <a
   href="../examples/callback.html">callback example</a> for an illustration. */
-  void drawNeeded();
+  TypedSignal<> drawNeeded;
 
   /*! Signal emitted at the end of the QGLViewer::paintGL() method, when frame
   is drawn.
@@ -561,46 +563,46 @@ public:
   Can be used to notify an image grabbing process that the image is ready. A
   typical example is to connect this signal to the saveSnapshot() method, so
   that a (numbered) snapshot is generated after each new display, in order to
-  create a movie: \code connect(viewer, SIGNAL(drawFinished(bool)),
-  SLOT(saveSnapshot(bool))); \endcode
+  create a movie: \code viewer->drawFinished.connect(std::bind(&Grabber::saveSnapshot,
+  grabber, std::placeholders::_1), grabber); \endcode
 
   The \p automatic bool variable is always \c true and has been added so that
   the signal can be connected to saveSnapshot() with an \c automatic value set
   to \c true. */
-  void drawFinished(bool automatic);
+  TypedSignal<bool> drawFinished;
 
   /*! Signal emitted by the default animate() method.
 
   Connect this signal to your scene animation method or overload animate(). */
-  void animateNeeded();
+  TypedSignal<> animateNeeded;
 
   /*! Signal emitted by the default QGLViewer::help() method.
 
   Connect this signal to your own help method or overload help(). */
-  void helpRequired();
+  TypedSignal<> helpRequired;
 
   /*! This signal is emitted whenever axisIsDrawn() changes value. */
-  void axisIsDrawnChanged(bool drawn);
+  TypedSignal<bool> axisIsDrawnChanged;
   /*! This signal is emitted whenever gridIsDrawn() changes value. */
-  void gridIsDrawnChanged(bool drawn);
+  TypedSignal<bool> gridIsDrawnChanged;
   /*! This signal is emitted whenever FPSIsDisplayed() changes value. */
-  void FPSIsDisplayedChanged(bool displayed);
+  TypedSignal<bool> FPSIsDisplayedChanged;
   /*! This signal is emitted whenever textIsEnabled() changes value. */
-  void textIsEnabledChanged(bool enabled);
+  TypedSignal<bool> textIsEnabledChanged;
   /*! This signal is emitted whenever cameraIsEdited() changes value.. */
-  void cameraIsEditedChanged(bool edited);
+  TypedSignal<bool> cameraIsEditedChanged;
   /*! Signal emitted by select().
 
   Connect this signal to your selection method or overload select(), or more
   probably simply drawWithNames(). */
-  void pointSelected(const QMouseEvent *e);
+  TypedSignal<const QMouseEvent *> pointSelected;
 
   /*! Signal emitted by setMouseGrabber() when the mouseGrabber() is changed.
 
   \p mouseGrabber is a pointer to the new MouseGrabber. Note that this signal is
   emitted with a \c nullptr parameter each time a MouseGrabber stops grabbing
   mouse. */
-  void mouseGrabberChanged(qglviewer::MouseGrabber *mouseGrabber);
+  TypedSignal<qglviewer::MouseGrabber *> mouseGrabberChanged;
 
   /*! @name Help window */
   //@{
@@ -667,7 +669,7 @@ public:
   \note All the OpenGL specific initializations must be done in this method: the
   OpenGL context is not yet available in your viewer constructor. */
   virtual void init() { 
-    emit("viewerInitialized"); 
+    viewerInitialized.emit();
   }
 
 
@@ -713,14 +715,27 @@ public:
   by select(). This value is set by endSelection(). See the select()
   documentation for details.
 
-  As a convention, this method returns -1 if the selectBuffer() was empty,
-  meaning that no object was selected.
+  As a convention, this method returns -1 if no object was drawn in the
+  selection region.
 
   Return value is -1 before the first call to select(). This value is modified
   using setSelectedName(). */
   int selectedName() const { return selectedObjectId_; }
+  /*! Returns the sorted names of all the objects visible in the selection
+  region by the last select(), selectAsync() or rectangle select(). Set by
+  endSelection(). */
+  const std::vector<int> &selectedNames() const { return selectedNames_; }
+  /*! True while a selectAsync() waits for its result. */
+  bool isSelectionPending() const {
+    return selectionIsAsync_ && idBuffer_.isPending();
+  }
+  /*! Returns the offscreen id framebuffer used by select(). */
+  qglviewer::IdBuffer &idBuffer() { return idBuffer_; }
   /*! Returns the selectBuffer() size.
 
+  \deprecated The selection no longer uses the \c GL_SELECT mode and this
+  buffer is not filled anymore. Kept for compatibility.
+
   See the select() documentation for details. Use setSelectBufferSize() to
   change this value.
 
@@ -735,9 +750,8 @@ public:
   The height of the selection frustum is defined by selectRegionHeight().
 
   The objects that will be drawn in this region by drawWithNames() will be
-  recorded in the selectBuffer(). endSelection() then analyzes this buffer and
-  setSelectedName() to the name of the closest object. See the gluPickMatrix()
-  documentation for details.
+  recorded in the idBuffer(). endSelection() then reads it back and
+  setSelectedName() to the name of the closest object.
 
   The default value is 3, which is adapted to standard applications. A smaller
   value results in a more precise selection but the user has to be careful for
@@ -751,15 +765,15 @@ public:
 
   /*! Returns a pointer to an array of \c GLuint.
 
-  This buffer is used by the \c GL_SELECT mode in select() to perform object
-  selection. The buffer size can be modified using setSelectBufferSize(). If you
-  overload endSelection(), you will analyze the content of this buffer. See the
-  \c glSelectBuffer() man page for details. */
+  \deprecated This buffer was used by the \c GL_SELECT mode, select() now
+  renders the ids in the idBuffer(). Kept for compatibility. */
   GLuint *selectBuffer() { return selectBuffer_; }
 
 public:
   virtual void select(const QMouseEvent *event);
   virtual void select(const QPoint &point);
+  virtual void select(const QPoint &corner1, const QPoint &corner2);
+  void selectAsync(const QPoint &point);
 
   void setSelectBufferSize(int size);
   /*! Sets the selectRegionWidth(). */
@@ -774,28 +788,36 @@ public:
 
 protected:
   virtual void beginSelection(const QPoint &point);
+  void pushName(int id);
+  void popName();
   /*! This method is called by select() and should draw selectable entities.
 
   Default implementation is empty. Overload and draw the different elements of
 your scene you want to be able to select. The default select() implementation
-relies on the \c GL_SELECT, and requires that each selectable element is drawn
-within a \c glPushName() - \c glPopName() block. A typical usage would be (see
+renders in the idBuffer(), and requires that each selectable element is drawn
+within a pushName() - popName() block. A typical usage would be (see
 the <a href="../examples/select.html">select example</a>): \code void
-Viewer::drawWithNames() { for (int i=0; i<nbObjects; ++i) { glPushName(i);
+Viewer::drawWithNames() { for (int i=0; i<nbObjects; ++i) { pushName(i);
     object(i)->draw();
-    glPopName();
+    popName();
    }
 }
 \endcode
 
+  The draws use the id program of the idBuffer(): only the positions (vertex
+attribute 0) are needed. In a compatibility context the fixed function
+modelview (\c glPushMatrix(), \c glMultMatrix()...) is honored, a core profile
+sets it with idBuffer().setModelView().
+
+  \attention \c glPushName() and \c glLoadName() are ignored since select() no
+longer uses \c GL_SELECT: replace them with pushName() and popName().
+
   The resulting selected name is computed by endSelection(), which
 setSelectedName() to the integer id pushed by this method (a value of -1 means
 no selection). Use selectedName() to update your selection, probably in the
 postSelection() method.
 
-  \attention If your selected objects are points, do not use \c
-glBegin(GL_POINTS); and \c glVertex3fv() in the above \c draw() method (not
-compatible with raster mode): use \c glRasterPos3fv() instead. */
+  */
   virtual void drawWithNames() {}
   virtual void endSelection(const QPoint &point);
   /*! This method is called at the end of the select() procedure. It should
@@ -1046,6 +1068,7 @@ private:
 
   // Set parameters to their default values. Called by the constructors.
   void defaultConstructor();
+  void addSignals();
 
   void handleKeyboardAction(KeyboardAction id);
 
@@ -1095,12 +1118,19 @@ private:
   bool mouseGrabberIsAManipulatedFrame_;
   bool mouseGrabberIsAManipulatedCameraFrame_;
   std::map<size_t, bool> disabledMouseGrabbers_;
+  qglviewer::MouseGrabberIndex mouseGrabberIndex_;
 
   // S e l e c t i o n
   int selectRegionWidth_, selectRegionHeight_;
   int selectBufferSize_;
   GLuint *selectBuffer_;
   int selectedObjectId_;
+  std::vector<int> selectedNames_;
+  std::vector<int> nameStack_;
+  qglviewer::IdBuffer idBuffer_;
+  bool selectionIsAsync_;
+  QPoint pendingSelection_;
+  void pollSelection();
 
   // V i s u a l   h i n t s
   int visualHint_;
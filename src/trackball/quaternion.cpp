@@ -244,7 +244,7 @@ void Quaternion::getMatrix(GLdouble m[4][4]) const {
 /*! Same as getMatrix(), but with a \c GLdouble[16] parameter. See also
  * getInverseMatrix() and Frame::getMatrix(). */
 void Quaternion::getMatrix(GLdouble m[16]) const {
-  static GLdouble mat[4][4];
+  GLdouble mat[4][4];
   getMatrix(mat);
   int count = 0;
   for (int i = 0; i < 4; ++i)
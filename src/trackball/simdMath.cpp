@@ -0,0 +1,471 @@
+#include "simdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+using namespace qglviewer;
+
+// The kernels read Quaternion and Vec arrays as plain qreal arrays
+static_assert(std::is_standard_layout<Quaternion>::value &&
+                  sizeof(Quaternion) == 4 * sizeof(qreal),
+              "Quaternion must be four packed qreals");
+static_assert(sizeof(Vec) == 3 * sizeof(qreal), "Vec must be three packed qreals");
+static_assert(sizeof(simd::Quat4f) == 4 * sizeof(float) &&
+                  sizeof(simd::Vec3f) == 3 * sizeof(float),
+              "Quat4f and Vec3f must be packed floats");
+static_assert(std::is_same<qreal, double>::value, "qreal must be double");
+
+namespace {
+
+// A pack holds four lanes, of doubles (PackD) or floats (PackF). It provides
+// +, -, *, and the load(), store(), splat() and transpose() overloads. The
+// kernels below are written once against this interface, and process four
+// Quaternions (or Vecs) at a time, one per lane.
+
+template <typename T> struct ScalarPack {
+  T v[4];
+
+  friend ScalarPack operator+(const ScalarPack &a, const ScalarPack &b) {
+    ScalarPack r;
+    for (int i = 0; i < 4; ++i)
+      r.v[i] = a.v[i] + b.v[i];
+    return r;
+  }
+  friend ScalarPack operator-(const ScalarPack &a, const ScalarPack &b) {
+    ScalarPack r;
+    for (int i = 0; i < 4; ++i)
+      r.v[i] = a.v[i] - b.v[i];
+    return r;
+  }
+  friend ScalarPack operator*(const ScalarPack &a, const ScalarPack &b) {
+    ScalarPack r;
+    for (int i = 0; i < 4; ++i)
+      r.v[i] = a.v[i] * b.v[i];
+    return r;
+  }
+};
+
+template <typename T> inline ScalarPack<T> scalarLoad(const T *p) {
+  ScalarPack<T> r;
+  for (int i = 0; i < 4; ++i)
+    r.v[i] = p[i];
+  return r;
+}
+
+template <typename T> inline void scalarStore(T *p, const ScalarPack<T> &a) {
+  for (int i = 0; i < 4; ++i)
+    p[i] = a.v[i];
+}
+
+template <typename T> inline ScalarPack<T> scalarSplat(T s) {
+  ScalarPack<T> r;
+  for (int i = 0; i < 4; ++i)
+    r.v[i] = s;
+  return r;
+}
+
+template <typename T>
+inline void scalarTranspose(ScalarPack<T> &a, ScalarPack<T> &b,
+                            ScalarPack<T> &c, ScalarPack<T> &d) {
+  ScalarPack<T> *rows[4] = {&a, &b, &c, &d};
+  for (int i = 0; i < 4; ++i)
+    for (int j = i + 1; j < 4; ++j)
+      std::swap(rows[i]->v[j], rows[j]->v[i]);
+}
+
+//////////////////////// Double precision ////////////////////////
+
+#if defined(__AVX__)
+
+static const char *const doublePath = "AVX";
+
+struct PackD {
+  __m256d v;
+  friend PackD operator+(PackD a, PackD b) { return {_mm256_add_pd(a.v, b.v)}; }
+  friend PackD operator-(PackD a, PackD b) { return {_mm256_sub_pd(a.v, b.v)}; }
+  friend PackD operator*(PackD a, PackD b) { return {_mm256_mul_pd(a.v, b.v)}; }
+};
+
+inline PackD load(const double *p) { return {_mm256_loadu_pd(p)}; }
+inline void store(double *p, PackD a) { _mm256_storeu_pd(p, a.v); }
+inline PackD splat(double s) { return {_mm256_set1_pd(s)}; }
+
+inline void transpose(PackD &a, PackD &b, PackD &c, PackD &d) {
+  const __m256d t0 = _mm256_unpacklo_pd(a.v, b.v); // a0 b0 a2 b2
+  const __m256d t1 = _mm256_unpackhi_pd(a.v, b.v); // a1 b1 a3 b3
+  const __m256d t2 = _mm256_unpacklo_pd(c.v, d.v); // c0 d0 c2 d2
+  const __m256d t3 = _mm256_unpackhi_pd(c.v, d.v); // c1 d1 c3 d3
+  a.v = _mm256_permute2f128_pd(t0, t2, 0x20);
+  b.v = _mm256_permute2f128_pd(t1, t3, 0x20);
+  c.v = _mm256_permute2f128_pd(t0, t2, 0x31);
+  d.v = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+static const char *const doublePath = "SSE2";
+
+// Two SSE2 registers of two doubles
+struct PackD {
+  __m128d lo, hi;
+  friend PackD operator+(PackD a, PackD b) {
+    return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)};
+  }
+  friend PackD operator-(PackD a, PackD b) {
+    return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)};
+  }
+  friend PackD operator*(PackD a, PackD b) {
+    return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)};
+  }
+};
+
+inline PackD load(const double *p) { return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)}; }
+inline void store(double *p, PackD a) {
+  _mm_storeu_pd(p, a.lo);
+  _mm_storeu_pd(p + 2, a.hi);
+}
+inline PackD splat(double s) { return {_mm_set1_pd(s), _mm_set1_pd(s)}; }
+
+inline void transpose(PackD &a, PackD &b, PackD &c, PackD &d) {
+  const PackD ta = {_mm_unpacklo_pd(a.lo, b.lo), _mm_unpacklo_pd(c.lo, d.lo)};
+  const PackD tb = {_mm_unpackhi_pd(a.lo, b.lo), _mm_unpackhi_pd(c.lo, d.lo)};
+  const PackD tc = {_mm_unpacklo_pd(a.hi, b.hi), _mm_unpacklo_pd(c.hi, d.hi)};
+  const PackD td = {_mm_unpackhi_pd(a.hi, b.hi), _mm_unpackhi_pd(c.hi, d.hi)};
+  a = ta;
+  b = tb;
+  c = tc;
+  d = td;
+}
+
+#else
+
+static const char *const doublePath = "scalar";
+
+typedef ScalarPack<double> PackD;
+inline PackD load(const double *p) { return scalarLoad(p); }
+inline void store(double *p, const PackD &a) { scalarStore(p, a); }
+inline PackD splat(double s) { return scalarSplat(s); }
+inline void transpose(PackD &a, PackD &b, PackD &c, PackD &d) {
+  scalarTranspose(a, b, c, d);
+}
+
+#endif
+
+//////////////////////// Single precision ////////////////////////
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+static const char *const floatPath = "SSE";
+
+struct PackF {
+  __m128 v;
+  friend PackF operator+(PackF a, PackF b) { return {_mm_add_ps(a.v, b.v)}; }
+  friend PackF operator-(PackF a, PackF b) { return {_mm_sub_ps(a.v, b.v)}; }
+  friend PackF operator*(PackF a, PackF b) { return {_mm_mul_ps(a.v, b.v)}; }
+};
+
+inline PackF load(const float *p) { return {_mm_loadu_ps(p)}; }
+inline void store(float *p, PackF a) { _mm_storeu_ps(p, a.v); }
+inline PackF splat(float s) { return {_mm_set1_ps(s)}; }
+inline void transpose(PackF &a, PackF &b, PackF &c, PackF &d) {
+  _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#else
+
+static const char *const floatPath = "scalar";
+
+typedef ScalarPack<float> PackF;
+inline PackF load(const float *p) { return scalarLoad(p); }
+inline void store(float *p, const PackF &a) { scalarStore(p, a); }
+inline PackF splat(float s) { return scalarSplat(s); }
+inline void transpose(PackF &a, PackF &b, PackF &c, PackF &d) {
+  scalarTranspose(a, b, c, d);
+}
+
+#endif
+
+//////////////////////// Kernels ////////////////////////
+
+// Loads four consecutive quaternions (16 values) as x, y, z and w packs
+template <typename T, typename P>
+inline void loadQuaternions(const T *q, P &x, P &y, P &z, P &w) {
+  x = load(q);
+  y = load(q + 4);
+  z = load(q + 8);
+  w = load(q + 12);
+  transpose(x, y, z, w);
+}
+
+template <typename T, typename P>
+inline void storeQuaternions(T *q, P x, P y, P z, P w) {
+  transpose(x, y, z, w);
+  store(q, x);
+  store(q + 4, y);
+  store(q + 8, z);
+  store(q + 12, w);
+}
+
+// Quaternion operator*()
+template <typename T> void multiply4(const T *a, const T *b, T *res) {
+  typedef decltype(load(a)) P;
+  P ax, ay, az, aw, bx, by, bz, bw;
+  loadQuaternions(a, ax, ay, az, aw);
+  loadQuaternions(b, bx, by, bz, bw);
+  storeQuaternions(res, aw * bx + bw * ax + ay * bz - az * by,
+                   aw * by + bw * ay + az * bx - ax * bz,
+                   aw * bz + bw * az + ax * by - ay * bx,
+                   aw * bw - bx * ax - ay * by - az * bz);
+}
+
+// Quaternion::getMatrix(GLdouble[16]) of four quaternions (64 values)
+template <typename T> void matrices4(const T *q, T *m) {
+  typedef decltype(load(q)) P;
+  P x, y, z, w;
+  loadQuaternions(q, x, y, z, w);
+
+  const P two = splat(T(2)), one = splat(T(1)), zero = splat(T(0));
+  const P q00 = two * x * x, q11 = two * y * y, q22 = two * z * z;
+  const P q01 = two * x * y, q02 = two * x * z, q03 = two * x * w;
+  const P q12 = two * y * z, q13 = two * y * w, q23 = two * z * w;
+
+  // the first three columns, transposed to get one matrix per register
+  P c[3][4] = {{one - q11 - q22, q01 + q23, q02 - q13, zero},
+               {q01 - q23, one - q22 - q00, q12 + q03, zero},
+               {q02 + q13, q12 - q03, one - q11 - q00, zero}};
+  for (int j = 0; j < 3; ++j) {
+    transpose(c[j][0], c[j][1], c[j][2], c[j][3]);
+    for (int k = 0; k < 4; ++k)
+      store(m + 16 * k + 4 * j, c[j][k]);
+  }
+  for (int k = 0; k < 4; ++k) {
+    T *t = m + 16 * k + 12;
+    t[0] = t[1] = t[2] = T(0);
+    t[3] = T(1);
+  }
+}
+
+// The 3x3 matrix of Quaternion::rotate(), in rows
+template <typename T> void rotationRows(const T *q, T r[9]) {
+  const T q00 = T(2) * q[0] * q[0], q11 = T(2) * q[1] * q[1],
+          q22 = T(2) * q[2] * q[2];
+  const T q01 = T(2) * q[0] * q[1], q02 = T(2) * q[0] * q[2],
+          q03 = T(2) * q[0] * q[3];
+  const T q12 = T(2) * q[1] * q[2], q13 = T(2) * q[1] * q[3],
+          q23 = T(2) * q[2] * q[3];
+  const T rows[9] = {T(1) - q11 - q22, q01 - q23,        q02 + q13,
+                     q01 + q23,        T(1) - q22 - q00, q12 - q03,
+                     q02 - q13,        q12 + q03,        T(1) - q11 - q00};
+  std::copy(rows, rows + 9, r);
+}
+
+// Quaternion::rotate() of four consecutive vectors (12 values)
+template <typename T, typename P>
+void rotate4(const P mat[9], const T *src, T *res) {
+  T x[4], y[4], z[4];
+  for (int i = 0; i < 4; ++i) {
+    x[i] = src[3 * i];
+    y[i] = src[3 * i + 1];
+    z[i] = src[3 * i + 2];
+  }
+  const P vx = load(x), vy = load(y), vz = load(z);
+  store(x, mat[0] * vx + mat[1] * vy + mat[2] * vz);
+  store(y, mat[3] * vx + mat[4] * vy + mat[5] * vz);
+  store(z, mat[6] * vx + mat[7] * vy + mat[8] * vz);
+  for (int i = 0; i < 4; ++i) {
+    res[3 * i] = x[i];
+    res[3 * i + 1] = y[i];
+    res[3 * i + 2] = z[i];
+  }
+}
+
+// Quaternion::slerp(). The dot products and the blend are vectorized, the
+// interpolation coefficients are computed per lane.
+template <typename T>
+void slerp4(const T *a, const T *b, const T *t, T *res, bool allowFlip) {
+  typedef decltype(load(a)) P;
+  P ax, ay, az, aw, bx, by, bz, bw;
+  loadQuaternions(a, ax, ay, az, aw);
+  loadQuaternions(b, bx, by, bz, bw);
+
+  T cosAngle[4], c1[4], c2[4];
+  store(cosAngle, ax * bx + ay * by + az * bz + aw * bw);
+  for (int i = 0; i < 4; ++i) {
+    const T absCos = std::fabs(cosAngle[i]);
+    if ((T(1) - absCos) < T(0.01)) {
+      // Linear interpolation for close orientations
+      c1[i] = T(1) - t[i];
+      c2[i] = t[i];
+    } else {
+      const T angle = std::acos(absCos);
+      const T sinAngle = std::sin(angle);
+      c1[i] = std::sin(angle * (T(1) - t[i])) / sinAngle;
+      c2[i] = std::sin(angle * t[i]) / sinAngle;
+    }
+    // Use the shortest path
+    if (allowFlip && (cosAngle[i] < T(0)))
+      c1[i] = -c1[i];
+  }
+
+  const P k1 = load(c1), k2 = load(c2);
+  storeQuaternions(res, k1 * ax + k2 * bx, k1 * ay + k2 * by,
+                   k1 * az + k2 * bz, k1 * aw + k2 * bw);
+}
+
+// The remaining n < 4 elements are padded with identity quaternions
+
+template <typename T> void identities(T *q, int n) {
+  for (int i = 0; i < n; ++i) {
+    q[4 * i] = q[4 * i + 1] = q[4 * i + 2] = T(0);
+    q[4 * i + 3] = T(1);
+  }
+}
+
+template <typename T> void multiplyAll(const T *a, const T *b, T *res, int n) {
+  const int body = n & ~3;
+  for (int i = 0; i < body; i += 4)
+    multiply4(a + 4 * i, b + 4 * i, res + 4 * i);
+  if (body == n)
+    return;
+
+  T ta[16], tb[16], tr[16];
+  identities(ta, 4);
+  identities(tb, 4);
+  std::copy(a + 4 * body, a + 4 * n, ta);
+  std::copy(b + 4 * body, b + 4 * n, tb);
+  multiply4(ta, tb, tr);
+  std::copy(tr, tr + 4 * (n - body), res + 4 * body);
+}
+
+template <typename T> void matricesAll(const T *q, T *m, int n) {
+  const int body = n & ~3;
+  for (int i = 0; i < body; i += 4)
+    matrices4(q + 4 * i, m + 16 * i);
+  if (body == n)
+    return;
+
+  T tq[16], tm[64];
+  identities(tq, 4);
+  std::copy(q + 4 * body, q + 4 * n, tq);
+  matrices4(tq, tm);
+  std::copy(tm, tm + 16 * (n - body), m + 16 * body);
+}
+
+template <typename T> void rotateAll(const T *q, const T *src, T *res, int n) {
+  typedef decltype(load(q)) P;
+  T rows[9];
+  rotationRows(q, rows);
+  P mat[9];
+  for (int k = 0; k < 9; ++k)
+    mat[k] = splat(rows[k]);
+
+  const int body = n & ~3;
+  for (int i = 0; i < body; i += 4)
+    rotate4(mat, src + 3 * i, res + 3 * i);
+  if (body == n)
+    return;
+
+  T ts[12] = {T(0)}, tr[12];
+  std::copy(src + 3 * body, src + 3 * n, ts);
+  rotate4(mat, ts, tr);
+  std::copy(tr, tr + 3 * (n - body), res + 3 * body);
+}
+
+template <typename T>
+void slerpAll(const T *a, const T *b, const T *t, T *res, int n,
+              bool allowFlip) {
+  const int body = n & ~3;
+  for (int i = 0; i < body; i += 4)
+    slerp4(a + 4 * i, b + 4 * i, t + i, res + 4 * i, allowFlip);
+  if (body == n)
+    return;
+
+  T ta[16], tb[16], tt[4] = {T(0)}, tr[16];
+  identities(ta, 4);
+  identities(tb, 4);
+  std::copy(a + 4 * body, a + 4 * n, ta);
+  std::copy(b + 4 * body, b + 4 * n, tb);
+  std::copy(t + body, t + n, tt);
+  slerp4(ta, tb, tt, tr, allowFlip);
+  std::copy(tr, tr + 4 * (n - body), res + 4 * body);
+}
+
+inline const double *values(const Quaternion *q) {
+  return reinterpret_cast<const double *>(q);
+}
+inline double *values(Quaternion *q) { return reinterpret_cast<double *>(q); }
+inline const double *values(const Vec *v) {
+  return reinterpret_cast<const double *>(v);
+}
+inline double *values(Vec *v) { return reinterpret_cast<double *>(v); }
+inline const float *values(const simd::Quat4f *q) {
+  return reinterpret_cast<const float *>(q);
+}
+inline float *values(simd::Quat4f *q) { return reinterpret_cast<float *>(q); }
+inline const float *values(const simd::Vec3f *v) {
+  return reinterpret_cast<const float *>(v);
+}
+inline float *values(simd::Vec3f *v) { return reinterpret_cast<float *>(v); }
+
+} // namespace
+
+/*! Returns the instruction sets used by the kernels, such as "double: AVX,
+ float: SSE". */
+const char *simd::path() {
+  static const std::string p =
+      std::string("double: ") + doublePath + ", float: " + floatPath;
+  return p.c_str();
+}
+
+/*! Sets \p res[i] to \p a[i] * \p b[i] (see Quaternion::operator*()), for \p i
+ in [0, \p n). */
+void simd::multiply(const Quaternion a[], const Quaternion b[], Quaternion res[],
+                    int n) {
+  multiplyAll(values(a), values(b), values(res), n);
+}
+
+/*! Sets \p res[i] to \p q.rotate(\p src[i]), for \p i in [0, \p n). The
+ rotation matrix is computed once. */
+void simd::rotate(const Quaternion &q, const Vec src[], Vec res[], int n) {
+  rotateAll(values(&q), values(src), values(res), n);
+}
+
+/*! Fills \p m with the \p n Quaternion::getMatrix() of \p q, 16 values each. */
+void simd::getMatrices(const Quaternion q[], GLdouble m[], int n) {
+  matricesAll(values(q), m, n);
+}
+
+/*! Sets \p res[i] to Quaternion::slerp(\p a[i], \p b[i], \p t[i], \p
+ allowFlip), for \p i in [0, \p n). */
+void simd::slerp(const Quaternion a[], const Quaternion b[], const qreal t[],
+                 Quaternion res[], int n, bool allowFlip) {
+  slerpAll(values(a), values(b), t, values(res), n, allowFlip);
+}
+
+/*! Single precision multiply(). */
+void simd::multiply(const Quat4f a[], const Quat4f b[], Quat4f res[], int n) {
+  multiplyAll(values(a), values(b), values(res), n);
+}
+
+/*! Single precision rotate(). */
+void simd::rotate(const Quat4f &q, const Vec3f src[], Vec3f res[], int n) {
+  rotateAll(values(&q), values(src), values(res), n);
+}
+
+/*! Single precision getMatrices(), in the glUniformMatrix4fv() layout. */
+void simd::getMatrices(const Quat4f q[], GLfloat m[], int n) {
+  matricesAll(values(q), m, n);
+}
+
+/*! Single precision slerp(). */
+void simd::slerp(const Quat4f a[], const Quat4f b[], const float t[],
+                 Quat4f res[], int n, bool allowFlip) {
+  slerpAll(values(a), values(b), t, values(res), n, allowFlip);
+}
@@ -0,0 +1,73 @@
+#ifndef QGLVIEWER_SIMD_MATH_H
+#define QGLVIEWER_SIMD_MATH_H
+
+#include "quaternion.h"
+#include "vec.h"
+
+namespace qglviewer {
+
+/*! \brief Batch Vec and Quaternion kernels, vectorized with SSE or AVX.
+
+  These functions apply the Quaternion operations (operator*(), rotate(),
+  getMatrix(), slerp()) to whole arrays. They give the same results as the
+  corresponding Quaternion methods, up to rounding.
+
+  The instruction set is selected at compile time: AVX when the compiler
+  targets it (\c -mavx or \c -march=native), SSE2 otherwise on x86, and a
+  portable scalar fallback on the other architectures. path() returns the
+  selected one.
+
+  Vec3f and Quat4f are the single precision variants, meant for render side
+  data (vertex buffers, instance matrices): their kernels process 4 values per
+  SSE register, twice as many as the double precision ones.
+
+  The arrays may not overlap, except \p res with one of the inputs of
+  multiply(), rotate() and slerp(). */
+namespace simd {
+
+/*! A single precision Vec. */
+struct Vec3f {
+  float x, y, z;
+
+  Vec3f() : x(0.0f), y(0.0f), z(0.0f) {}
+  Vec3f(float X, float Y, float Z) : x(X), y(Y), z(Z) {}
+  explicit Vec3f(const Vec &v) : x(float(v.x)), y(float(v.y)), z(float(v.z)) {}
+  Vec toVec() const { return Vec(x, y, z); }
+};
+
+/*! A single precision Quaternion, with the same {x, y, z, w} layout. */
+struct Quat4f {
+  float x, y, z, w;
+
+  Quat4f() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+  Quat4f(float X, float Y, float Z, float W) : x(X), y(Y), z(Z), w(W) {}
+  explicit Quat4f(const Quaternion &q)
+      : x(float(q[0])), y(float(q[1])), z(float(q[2])), w(float(q[3])) {}
+  Quaternion toQuaternion() const { return Quaternion(x, y, z, w); }
+};
+
+const char *path();
+
+/*! @name Double precision */
+//@{
+void multiply(const Quaternion a[], const Quaternion b[], Quaternion res[],
+              int n);
+void rotate(const Quaternion &q, const Vec src[], Vec res[], int n);
+void getMatrices(const Quaternion q[], GLdouble m[], int n);
+void slerp(const Quaternion a[], const Quaternion b[], const qreal t[],
+           Quaternion res[], int n, bool allowFlip = true);
+//@}
+
+/*! @name Single precision */
+//@{
+void multiply(const Quat4f a[], const Quat4f b[], Quat4f res[], int n);
+void rotate(const Quat4f &q, const Vec3f src[], Vec3f res[], int n);
+void getMatrices(const Quat4f q[], GLfloat m[], int n);
+void slerp(const Quat4f a[], const Quat4f b[], const float t[], Quat4f res[],
+           int n, bool allowFlip = true);
+//@}
+
+} // namespace simd
+} // namespace qglviewer
+
+#endif // QGLVIEWER_SIMD_MATH_H
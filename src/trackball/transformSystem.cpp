@@ -0,0 +1,377 @@
+#include "transformSystem.h"
+#include "frame.h"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using namespace qglviewer;
+
+// levels smaller than this are updated by the calling thread only
+static const int minParallelSize = 4096;
+
+/*! Threads waiting for the chunks of a level. The calling thread runs chunk 0,
+ worker \c t chunk \c t + 1. */
+struct TransformSystem::Workers {
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable started, finished;
+  std::function<void(int)> job;
+  int nbChunks = 0;
+  int remaining = 0;
+  unsigned int generation = 0;
+  bool quit = false;
+
+  explicit Workers(int count) {
+    for (int t = 0; t < count; ++t)
+      threads.emplace_back(&Workers::loop, this, t + 1);
+  }
+
+  ~Workers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      quit = true;
+    }
+    started.notify_all();
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  void loop(int chunk) {
+    unsigned int seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      started.wait(lock, [&]() { return quit || generation != seen; });
+      if (quit)
+        return;
+      seen = generation;
+      if (chunk >= nbChunks)
+        continue;
+      lock.unlock();
+      job(chunk);
+      lock.lock();
+      if (--remaining == 0)
+        finished.notify_one();
+    }
+  }
+
+  /*! Runs \p run(0) ... \p run(\p count - 1), returns once all are done. */
+  void run(int count, std::function<void(int)> run) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job = std::move(run);
+      nbChunks = count;
+      remaining = count - 1;
+      ++generation;
+    }
+    started.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return remaining == 0; });
+  }
+};
+
+TransformSystem::TransformSystem()
+    : sorted_(true), threadCount_(1), updatedCount_(0) {
+  setThreadCount(int(std::thread::hardware_concurrency()));
+}
+
+TransformSystem::~TransformSystem() {}
+
+/*! Sets the number of threads used by update(), the calling one included.
+ Default is the number of hardware threads. The other threads are started here
+ and stopped by the next setThreadCount() or the destructor. */
+void TransformSystem::setThreadCount(int count) {
+  count = std::max(count, 1);
+  if (count == threadCount_ && (count == 1 || workers_))
+    return;
+  workers_.reset();
+  threadCount_ = count;
+  if (count > 1)
+    workers_.reset(new Workers(count - 1));
+}
+
+/*! Adds a transform, defined by its \p translation and \p rotation relative to
+ \p parent (-1 for the world coordinate system), and returns its Id. */
+TransformSystem::Id TransformSystem::add(const Vec &translation,
+                                         const Quaternion &rotation,
+                                         Id parent) {
+  Id id;
+  if (freeIds_.empty()) {
+    id = Id(slotOf_.size());
+    slotOf_.push_back(-1);
+    parentId_.push_back(-1);
+  } else {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  }
+
+  const int slot = int(idOf_.size());
+  slotOf_[id] = slot;
+  idOf_.push_back(id);
+  parentId_[id] = contains(parent) ? parent : -1;
+  translation_.push_back(translation);
+  rotation_.push_back(rotation);
+  parentSlot_.push_back(-1);
+  dirty_.push_back(1);
+  changed_.push_back(0);
+  position_.push_back(translation);
+  orientation_.push_back(rotation);
+  worldMatrix_.resize(worldMatrix_.size() + 16, 0.0);
+
+  // the new slot is last, whatever its depth
+  sorted_ = false;
+  return id;
+}
+
+/*! Adds a transform that copies \p frame: its position() and orientation() when
+ \p parent is -1, its translation() and rotation() otherwise (\p parent then
+ stands for the Frame::referenceFrame()). */
+TransformSystem::Id TransformSystem::add(const Frame &frame, Id parent) {
+  if (parent < 0)
+    return add(frame.position(), frame.orientation());
+  return add(frame.translation(), frame.rotation(), parent);
+}
+
+/*! Removes \p id. Its children become roots, with unchanged translation and
+ rotation (as when a Frame referenceFrame() is deleted). The other Ids remain
+ valid. This is linear in the number of transforms. */
+void TransformSystem::remove(Id id) {
+  if (!contains(id))
+    return;
+
+  for (size_t i = 0; i < parentId_.size(); ++i)
+    if (parentId_[i] == id) {
+      parentId_[i] = -1;
+      markDirty(slotOf_[i]);
+    }
+
+  // move the last slot in the removed one
+  const int slot = slotOf_[id];
+  const int last = int(idOf_.size()) - 1;
+  if (slot != last) {
+    const Id moved = idOf_[last];
+    idOf_[slot] = moved;
+    slotOf_[moved] = slot;
+    translation_[slot] = translation_[last];
+    rotation_[slot] = rotation_[last];
+    dirty_[slot] = dirty_[last];
+    position_[slot] = position_[last];
+    orientation_[slot] = orientation_[last];
+    std::copy(worldMatrix_.begin() + 16 * last,
+              worldMatrix_.begin() + 16 * (last + 1),
+              worldMatrix_.begin() + 16 * slot);
+  }
+  idOf_.pop_back();
+  translation_.pop_back();
+  rotation_.pop_back();
+  parentSlot_.pop_back();
+  dirty_.pop_back();
+  changed_.pop_back();
+  position_.pop_back();
+  orientation_.pop_back();
+  worldMatrix_.resize(worldMatrix_.size() - 16);
+
+  slotOf_[id] = -1;
+  parentId_[id] = -1;
+  freeIds_.push_back(id);
+  sorted_ = false;
+}
+
+/*! Removes all the transforms. */
+void TransformSystem::clear() {
+  translation_.clear();
+  rotation_.clear();
+  parentSlot_.clear();
+  dirty_.clear();
+  changed_.clear();
+  position_.clear();
+  orientation_.clear();
+  worldMatrix_.clear();
+  slotOf_.clear();
+  idOf_.clear();
+  parentId_.clear();
+  freeIds_.clear();
+  levelStart_.clear();
+  sorted_ = true;
+}
+
+bool TransformSystem::wouldCreateALoop(Id id, Id parent) const {
+  for (Id p = parent; p >= 0; p = parentId_[p])
+    if (p == id)
+      return true;
+  return false;
+}
+
+/*! Sets the parent of \p id (-1 for a root). Its translation() and rotation()
+ are kept, and are now relative to \p parent. A warning is printed and nothing
+ is done if this would create a loop in the hierarchy. */
+void TransformSystem::setParent(Id id, Id parent) {
+  if (!contains(parent))
+    parent = -1;
+  if (parentId_[id] == parent)
+    return;
+  if (wouldCreateALoop(id, parent)) {
+    std::cerr << "TransformSystem::setParent would create a loop in the hierarchy" << std::endl;
+    return;
+  }
+  parentId_[id] = parent;
+  markDirty(slotOf_[id]);
+  sorted_ = false;
+}
+
+void TransformSystem::setTranslation(Id id, const Vec &translation) {
+  const int slot = slotOf_[id];
+  translation_[slot] = translation;
+  markDirty(slot);
+}
+
+void TransformSystem::setRotation(Id id, const Quaternion &rotation) {
+  const int slot = slotOf_[id];
+  rotation_[slot] = rotation;
+  markDirty(slot);
+}
+
+void TransformSystem::setTranslationAndRotation(Id id, const Vec &translation,
+                                                const Quaternion &rotation) {
+  const int slot = slotOf_[id];
+  translation_[slot] = translation;
+  rotation_[slot] = rotation;
+  markDirty(slot);
+}
+
+/*! Sorts the slots by depth (a stable counting sort), so that parents are
+ always updated before their children. */
+void TransformSystem::sort() {
+  const int n = size();
+
+  // depth of each slot, memoized along the parent chains
+  std::vector<int> depth(n, -1);
+  std::vector<int> chain;
+  int maxDepth = 0;
+  for (int s = 0; s < n; ++s) {
+    int cur = s;
+    while (depth[cur] < 0) {
+      chain.push_back(cur);
+      const Id p = parentId_[idOf_[cur]];
+      if (p < 0)
+        break;
+      cur = slotOf_[p];
+    }
+    int d = depth[cur] < 0 ? -1 : depth[cur];
+    while (!chain.empty()) {
+      depth[chain.back()] = ++d;
+      chain.pop_back();
+    }
+    maxDepth = std::max(maxDepth, depth[s]);
+  }
+
+  levelStart_.assign(maxDepth + 2, 0);
+  for (int s = 0; s < n; ++s)
+    ++levelStart_[depth[s] + 1];
+  for (int d = 0; d <= maxDepth; ++d)
+    levelStart_[d + 1] += levelStart_[d];
+
+  std::vector<int> newSlot(n);
+  std::vector<int> fill(levelStart_.begin(), levelStart_.end() - 1);
+  for (int s = 0; s < n; ++s)
+    newSlot[s] = fill[depth[s]]++;
+
+  // permute all the per slot arrays
+  std::vector<Vec> translation(n), position(n);
+  std::vector<Quaternion> rotation(n), orientation(n);
+  std::vector<unsigned char> dirty(n);
+  std::vector<GLdouble> worldMatrix(16 * n);
+  std::vector<Id> idOf(n);
+  for (int s = 0; s < n; ++s) {
+    const int t = newSlot[s];
+    translation[t] = translation_[s];
+    rotation[t] = rotation_[s];
+    dirty[t] = dirty_[s];
+    position[t] = position_[s];
+    orientation[t] = orientation_[s];
+    std::copy(worldMatrix_.begin() + 16 * s, worldMatrix_.begin() + 16 * (s + 1),
+              worldMatrix.begin() + 16 * t);
+    idOf[t] = idOf_[s];
+  }
+  translation_.swap(translation);
+  rotation_.swap(rotation);
+  dirty_.swap(dirty);
+  position_.swap(position);
+  orientation_.swap(orientation);
+  worldMatrix_.swap(worldMatrix);
+  idOf_.swap(idOf);
+
+  for (int s = 0; s < n; ++s)
+    slotOf_[idOf_[s]] = s;
+  for (int s = 0; s < n; ++s) {
+    const Id p = parentId_[idOf_[s]];
+    parentSlot_[s] = p < 0 ? -1 : slotOf_[p];
+  }
+  sorted_ = true;
+}
+
+/*! The slots of [\p begin, \p end) all have the same depth: their parents are
+ already up to date, and they can be updated concurrently. */
+void TransformSystem::updateRange(int begin, int end) {
+  for (int s = begin; s < end; ++s) {
+    const int p = parentSlot_[s];
+    if (!dirty_[s] && (p < 0 || !changed_[p])) {
+      changed_[s] = 0;
+      continue;
+    }
+
+    if (p < 0) {
+      position_[s] = translation_[s];
+      orientation_[s] = rotation_[s];
+    } else {
+      position_[s] = position_[p] + orientation_[p].rotate(translation_[s]);
+      orientation_[s] = orientation_[p] * rotation_[s];
+    }
+
+    GLdouble *m = &worldMatrix_[16 * s];
+    orientation_[s].getMatrix(m);
+    m[12] = position_[s][0];
+    m[13] = position_[s][1];
+    m[14] = position_[s][2];
+
+    dirty_[s] = 0;
+    changed_[s] = 1;
+  }
+}
+
+/*! Recomputes the world transforms of the modified transforms and of their
+ descendants, level by level. Large levels are split between threadCount()
+ threads, the smaller ones are updated by the calling thread. */
+void TransformSystem::update() {
+  if (!sorted_)
+    sort();
+
+  const int nbLevels = int(levelStart_.size()) - 1;
+  for (int d = 0; d < nbLevels; ++d) {
+    const int begin = levelStart_[d];
+    const int end = levelStart_[d + 1];
+    const int nbThreads =
+        std::min(threadCount_, std::max(1, (end - begin) / minParallelSize));
+    if (nbThreads <= 1) {
+      updateRange(begin, end);
+      continue;
+    }
+
+    const int chunk = (end - begin + nbThreads - 1) / nbThreads;
+    workers_->run(nbThreads, [this, begin, end, chunk](int t) {
+      const int b = begin + t * chunk;
+      updateRange(std::min(b, end), std::min(b + chunk, end));
+    });
+  }
+
+  updatedCount_ = int(std::count(changed_.begin(), changed_.end(), 1));
+}
+
+/*! Sets the position and orientation of \p frame to the world transform of
+ \p id at the last update(). */
+void TransformSystem::copyTo(Id id, Frame &frame) const {
+  frame.setPositionAndOrientation(position(id), orientation(id));
+}
@@ -0,0 +1,161 @@
+#ifndef QGLVIEWER_TRANSFORM_SYSTEM_H
+#define QGLVIEWER_TRANSFORM_SYSTEM_H
+
+#include "quaternion.h"
+#include "vec.h"
+#include <memory>
+#include <vector>
+
+namespace qglviewer {
+class Frame;
+
+/*! \brief A structure of arrays store for large numbers of transforms.
+  \class TransformSystem transformSystem.h QGLViewer/transformSystem.h
+
+  A Frame is a full object (signals, virtual methods, its own allocation). When
+  a scene holds hundreds of thousands of coordinate systems that are only
+  moved and read back, store them in a TransformSystem instead: each transform
+  is a few entries in contiguous arrays (local translation and rotation,
+  parent, world position, orientation and matrix), addressed by an Id.
+
+  The arrays are sorted by depth in the hierarchy (roots first), so that
+  update() computes all the world transforms in a single pass, one level
+  after the other, each level being split between threads when it is large
+  enough. The threads are started once, by setThreadCount(), and wait for the
+  next large level in between. Only the transforms that were modified, or whose parent world
+  transform changed, are recomputed.
+
+  The setters only record the local values: position(), orientation() and
+  worldMatrix() are those of the last update().
+
+  A Handle gives a Frame like interface to one transform. add(const Frame&) and
+  copyTo() convert from and to Frames, for the few objects that need to be
+  manipulated with the mouse or interpolated. */
+class TransformSystem {
+public:
+  /*! Identifies a transform. Ids are stable: they do not change when the
+  arrays are sorted. -1 means none (world coordinate system). */
+  typedef int Id;
+
+  /*! A lightweight handle (a pointer and an index) on one transform. */
+  class Handle {
+  public:
+    Handle(TransformSystem *system = nullptr, Id id = -1)
+        : system_(system), id_(id) {}
+
+    Id id() const { return id_; }
+    bool isValid() const { return system_ && system_->contains(id_); }
+
+    void setTranslation(const Vec &translation) {
+      system_->setTranslation(id_, translation);
+    }
+    void setRotation(const Quaternion &rotation) {
+      system_->setRotation(id_, rotation);
+    }
+    void setTranslationAndRotation(const Vec &translation,
+                                   const Quaternion &rotation) {
+      system_->setTranslationAndRotation(id_, translation, rotation);
+    }
+    Vec translation() const { return system_->translation(id_); }
+    Quaternion rotation() const { return system_->rotation(id_); }
+
+    void setParent(const Handle &parent) { system_->setParent(id_, parent.id_); }
+    Handle parent() const { return Handle(system_, system_->parent(id_)); }
+
+    Vec position() const { return system_->position(id_); }
+    Quaternion orientation() const { return system_->orientation(id_); }
+    const GLdouble *worldMatrix() const { return system_->worldMatrix(id_); }
+
+  private:
+    TransformSystem *system_;
+    Id id_;
+  };
+
+  TransformSystem();
+  ~TransformSystem();
+  // The worker threads belong to one system
+  TransformSystem(const TransformSystem &) = delete;
+  TransformSystem &operator=(const TransformSystem &) = delete;
+
+  Id add(const Vec &translation = Vec(),
+         const Quaternion &rotation = Quaternion(), Id parent = -1);
+  Id add(const Frame &frame, Id parent = -1);
+  void remove(Id id);
+  void clear();
+  /*! Returns a Handle on \p id. */
+  Handle handle(Id id) { return Handle(this, id); }
+
+  /*! Returns the number of transforms. */
+  int size() const { return int(idOf_.size()); }
+  bool contains(Id id) const {
+    return id >= 0 && id < int(slotOf_.size()) && slotOf_[id] >= 0;
+  }
+
+  void setParent(Id id, Id parent);
+  /*! Returns the parent of \p id, -1 for a root. */
+  Id parent(Id id) const { return parentId_[id]; }
+
+  void setTranslation(Id id, const Vec &translation);
+  void setRotation(Id id, const Quaternion &rotation);
+  void setTranslationAndRotation(Id id, const Vec &translation,
+                                 const Quaternion &rotation);
+  /*! Returns the translation of \p id, relative to its parent(). */
+  Vec translation(Id id) const { return translation_[slotOf_[id]]; }
+  /*! Returns the rotation of \p id, relative to its parent(). */
+  Quaternion rotation(Id id) const { return rotation_[slotOf_[id]]; }
+
+  void update();
+
+  /*! World position of \p id at the last update(). */
+  Vec position(Id id) const { return position_[slotOf_[id]]; }
+  /*! World orientation of \p id at the last update(). */
+  Quaternion orientation(Id id) const { return orientation_[slotOf_[id]]; }
+  /*! World matrix of \p id at the last update(), in the Frame::worldMatrix()
+  format. Valid until the next update(). */
+  const GLdouble *worldMatrix(Id id) const {
+    return &worldMatrix_[16 * slotOf_[id]];
+  }
+  void copyTo(Id id, Frame &frame) const;
+
+  void setThreadCount(int count);
+  int threadCount() const { return threadCount_; }
+
+  /*! Returns the number of world transforms recomputed by the last update(). */
+  int updatedCount() const { return updatedCount_; }
+
+private:
+  void markDirty(int slot) { dirty_[slot] = 1; }
+  void sort();
+  void updateRange(int begin, int end);
+  bool wouldCreateALoop(Id id, Id parent) const;
+
+  struct Workers;
+
+  // Per slot, sorted by depth: local transform, parent slot and world values
+  std::vector<Vec> translation_;
+  std::vector<Quaternion> rotation_;
+  std::vector<int> parentSlot_;
+  std::vector<unsigned char> dirty_;   // local transform or parent modified
+  std::vector<unsigned char> changed_; // world recomputed by this update()
+  std::vector<Vec> position_;
+  std::vector<Quaternion> orientation_;
+  std::vector<GLdouble> worldMatrix_; // 16 per slot
+
+  // Id <-> slot
+  std::vector<int> slotOf_;   // -1 for a free id
+  std::vector<Id> idOf_;
+  std::vector<Id> parentId_;  // by id, the hierarchy itself
+  std::vector<Id> freeIds_;
+
+  // levelStart_[d] is the first slot of depth d
+  std::vector<int> levelStart_;
+  bool sorted_;
+
+  int threadCount_;
+  std::unique_ptr<Workers> workers_; // threadCount() - 1 threads
+  int updatedCount_;
+};
+
+} // namespace qglviewer
+
+#endif // QGLVIEWER_TRANSFORM_SYSTEM_H
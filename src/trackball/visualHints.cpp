@@ -0,0 +1,366 @@
+#include "visualHints.h"
+#include <cmath>
+#include <iostream>
+
+using namespace qglviewer;
+
+namespace {
+const char *vertexCode = R"(#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 color;
+
+uniform mat4 modelView;
+uniform mat4 projection;
+uniform float scale;
+// radius / length of a drawArrow() arrow, which is shaped here, 0 otherwise
+uniform float arrowRatio;
+
+out vec3 vertexNormal;
+out vec3 vertexColor;
+
+void main()
+{
+	vec3 p = position;
+	vec3 n = normal;
+	if (arrowRatio > 0.0) {
+		// position is (cos, sin, part), see VisualHints::addArrow()
+		float head = 2.5 * arrowRatio + 0.1;
+		float coneRadius = (4.0 - 5.0 * head) * arrowRatio;
+		float cylinderLength = 1.0 - head / (4.0 - 5.0 * head);
+		float slant = sqrt(coneRadius * coneRadius + head * head);
+		vec2 direction = position.xy;
+		if (position.z < 1.5) {
+			p = vec3(arrowRatio * direction, position.z * cylinderLength);
+			n = vec3(direction, 0.0);
+		} else {
+			p = position.z < 2.5 ? vec3(coneRadius * direction, 1.0 - head) : vec3(0.0, 0.0, 1.0);
+			n = vec3(head / slant * direction, coneRadius / slant);
+		}
+	}
+	vec4 eyePosition = modelView * vec4(scale * p, 1.0);
+	gl_Position = projection * eyePosition;
+	vertexNormal = mat3(modelView) * n;
+	vertexColor = color;
+}
+)";
+
+// lit geometry uses a headlight, as the default QGLViewer GL_LIGHT0
+const char *fragmentCode = R"(#version 330 core
+in vec3 vertexNormal;
+in vec3 vertexColor;
+
+uniform vec4 color;
+uniform bool lit;
+
+out vec4 FragColor;
+
+void main()
+{
+	vec3 c = vertexColor * color.rgb;
+	if (lit)
+		c *= 0.2 + 0.8 * abs(normalize(vertexNormal).z);
+	FragColor = vec4(c, color.a);
+}
+)";
+
+const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+} // namespace
+
+VisualHints::VisualHints()
+    : program_(0), modelViewLocation_(-1), projectionLocation_(-1),
+      scaleLocation_(-1), arrowRatioLocation_(-1), colorLocation_(-1),
+      litLocation_(-1),
+      gridSubdivisions_(-1) {}
+
+/*! Returns the instance used by QGLViewer::drawGrid(), drawAxis() and
+ drawArrow(). */
+VisualHints &VisualHints::shared() {
+  static VisualHints hints;
+  return hints;
+}
+
+void VisualHints::initProgram() {
+  GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex, 1, &vertexCode, NULL);
+  glCompileShader(vertex);
+  GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment, 1, &fragmentCode, NULL);
+  glCompileShader(fragment);
+
+  program_ = glCreateProgram();
+  glAttachShader(program_, vertex);
+  glAttachShader(program_, fragment);
+  glLinkProgram(program_);
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+
+  GLint success;
+  glGetProgramiv(program_, GL_LINK_STATUS, &success);
+  if (!success) {
+    char infoLog[1024];
+    glGetProgramInfoLog(program_, 1024, NULL, infoLog);
+    std::cerr << "ERROR::VISUALHINTS::PROGRAM_LINKING_ERROR\n"
+              << infoLog << std::endl;
+  }
+
+  modelViewLocation_ = glGetUniformLocation(program_, "modelView");
+  projectionLocation_ = glGetUniformLocation(program_, "projection");
+  scaleLocation_ = glGetUniformLocation(program_, "scale");
+  arrowRatioLocation_ = glGetUniformLocation(program_, "arrowRatio");
+  colorLocation_ = glGetUniformLocation(program_, "color");
+  litLocation_ = glGetUniformLocation(program_, "lit");
+}
+
+void VisualHints::upload(Geometry &geometry,
+                         const std::vector<Vertex> &vertices) {
+  GLint previousVao;
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVao);
+
+  if (!geometry.vao) {
+    glGenVertexArrays(1, &geometry.vao);
+    glGenBuffers(1, &geometry.vbo);
+    glBindVertexArray(geometry.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, geometry.vbo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void *)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void *)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void *)offsetof(Vertex, color));
+    glEnableVertexAttribArray(2);
+  } else
+    glBindBuffer(GL_ARRAY_BUFFER, geometry.vbo);
+
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
+               vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(previousVao);
+}
+
+void VisualHints::destroy(Geometry &geometry) {
+  if (!geometry.vao)
+    return;
+  glDeleteVertexArrays(1, &geometry.vao);
+  glDeleteBuffers(1, &geometry.vbo);
+  geometry = Geometry();
+}
+
+void VisualHints::release() {
+  destroy(grid_);
+  gridSubdivisions_ = -1;
+  destroy(axis_);
+  for (auto &arrow : arrows_)
+    destroy(arrow.second);
+  arrows_.clear();
+  if (program_)
+    glDeleteProgram(program_);
+  program_ = 0;
+}
+
+void VisualHints::draw(const Geometry &geometry, const GLfloat modelView[16],
+                       const GLfloat projection[16], qreal scale,
+                       const float lineColor[4],
+                       const float triangleColor[4], qreal arrowRatio) {
+  GLint previousProgram, previousVao;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVao);
+
+  glUseProgram(program_);
+  glUniformMatrix4fv(modelViewLocation_, 1, GL_FALSE, modelView);
+  glUniformMatrix4fv(projectionLocation_, 1, GL_FALSE, projection);
+  glUniform1f(scaleLocation_, static_cast<float>(scale));
+  glUniform1f(arrowRatioLocation_, static_cast<float>(arrowRatio));
+  glBindVertexArray(geometry.vao);
+
+  if (geometry.lines > 0) {
+    glUniform4fv(colorLocation_, 1, lineColor);
+    glUniform1i(litLocation_, 0);
+    glDrawArrays(GL_LINES, 0, geometry.lines);
+  }
+  if (geometry.triangles > 0) {
+    glUniform4fv(colorLocation_, 1, triangleColor);
+    glUniform1i(litLocation_, 1);
+    glDrawArrays(GL_TRIANGLES, geometry.lines, geometry.triangles);
+  }
+
+  glBindVertexArray(previousVao);
+  glUseProgram(previousProgram);
+}
+
+/*! Appends the triangles of a unit length arrow along the positive Z axis
+(\p axis 2), rotated along X (\p axis 0) or Y (\p axis 1). Same geometry as the
+original gluCylinder() based QGLViewer::drawArrow(): an open cylinder and an
+open cone, without caps.
+
+With a null \p ratio the arrow is left to the vertex shader, which shapes it
+from its arrowRatio uniform: each vertex position is then only (cos, sin, part)
+of its angle, part being 0 and 1 for the bottom and the top of the cylinder, 2
+for the base of the cone and 3 for its apex. */
+void VisualHints::addArrow(std::vector<Vertex> &vertices, qreal ratio,
+                           int nbSubdivisions, const float color[3],
+                           int axis) {
+  const qreal head = 2.5 * ratio + 0.1;
+  const qreal coneRadius = (4.0 - 5.0 * head) * ratio;
+  const qreal cylinderLength = 1.0 - head / (4.0 - 5.0 * head);
+  const qreal coneBase = 1.0 - head;
+
+  // the cone normal leans towards its apex
+  const qreal slant = std::sqrt(coneRadius * coneRadius + head * head);
+  const qreal coneNormalZ = coneRadius / slant;
+  const qreal coneNormalR = head / slant;
+
+  // (x, y, z) of the Z arrow to the requested axis
+  auto vertex = [&](qreal c, qreal s, int part) {
+    qreal p[3] = {c, s, static_cast<qreal>(part)}, n[3] = {c, s, 0.0};
+    if (ratio > 0.0) {
+      if (part < 2) {
+        p[0] = ratio * c;
+        p[1] = ratio * s;
+        p[2] = part == 0 ? 0.0 : cylinderLength;
+      } else {
+        p[0] = part == 2 ? coneRadius * c : 0.0;
+        p[1] = part == 2 ? coneRadius * s : 0.0;
+        p[2] = part == 2 ? coneBase : 1.0;
+        n[0] = coneNormalR * c;
+        n[1] = coneNormalR * s;
+        n[2] = coneNormalZ;
+      }
+    }
+    Vertex v;
+    const int index[3][3] = {{2, 1, 0}, {0, 2, 1}, {0, 1, 2}};
+    const float sign[3][3] = {{1, 1, -1}, {1, 1, -1}, {1, 1, 1}};
+    for (int i = 0; i < 3; ++i) {
+      v.position[i] = sign[axis][i] * static_cast<float>(p[index[axis][i]]);
+      v.normal[i] = sign[axis][i] * static_cast<float>(n[index[axis][i]]);
+      v.color[i] = color[i];
+    }
+    vertices.push_back(v);
+  };
+
+  for (int i = 0; i < nbSubdivisions; ++i) {
+    const qreal a0 = 2.0 * M_PI * i / nbSubdivisions;
+    const qreal a1 = 2.0 * M_PI * (i + 1) / nbSubdivisions;
+    const qreal c0 = std::cos(a0), s0 = std::sin(a0);
+    const qreal c1 = std::cos(a1), s1 = std::sin(a1);
+
+    vertex(c0, s0, 0);
+    vertex(c1, s1, 0);
+    vertex(c1, s1, 1);
+    vertex(c0, s0, 0);
+    vertex(c1, s1, 1);
+    vertex(c0, s0, 1);
+
+    vertex(c0, s0, 2);
+    vertex(c1, s1, 2);
+    vertex(std::cos(0.5 * (a0 + a1)), std::sin(0.5 * (a0 + a1)), 3);
+  }
+}
+
+/*! Draws a grid in the XY plane, see QGLViewer::drawGrid(). */
+void VisualHints::drawGrid(const GLfloat modelView[16],
+                           const GLfloat projection[16], qreal size,
+                           int nbSubdivisions, const float color[4]) {
+  if (!program_)
+    initProgram();
+
+  if (nbSubdivisions != gridSubdivisions_) {
+    std::vector<Vertex> vertices;
+    for (int i = 0; i <= nbSubdivisions; ++i) {
+      const float pos = static_cast<float>(2.0 * i / nbSubdivisions - 1.0);
+      vertices.push_back({{pos, -1.0f, 0.0f}, {0, 0, 1}, {1, 1, 1}});
+      vertices.push_back({{pos, +1.0f, 0.0f}, {0, 0, 1}, {1, 1, 1}});
+      vertices.push_back({{-1.0f, pos, 0.0f}, {0, 0, 1}, {1, 1, 1}});
+      vertices.push_back({{+1.0f, pos, 0.0f}, {0, 0, 1}, {1, 1, 1}});
+    }
+    upload(grid_, vertices);
+    grid_.lines = static_cast<GLsizei>(vertices.size());
+    gridSubdivisions_ = nbSubdivisions;
+  }
+
+  draw(grid_, modelView, projection, size, color, color);
+}
+
+/*! Draws the X, Y and Z arrows and letters, see QGLViewer::drawAxis(). The
+letters use \p color, the arrows keep their own colors. */
+void VisualHints::drawAxis(const GLfloat modelView[16],
+                           const GLfloat projection[16], qreal length,
+                           const float color[4]) {
+  if (!program_)
+    initProgram();
+
+  if (!axis_.vao) {
+    const float charWidth = 1.0f / 40.0f;
+    const float charHeight = 1.0f / 30.0f;
+    const float charShift = 1.04f;
+    const float letters[][3] = {
+        // The X
+        {charShift, charWidth, -charHeight},
+        {charShift, -charWidth, charHeight},
+        {charShift, -charWidth, -charHeight},
+        {charShift, charWidth, charHeight},
+        // The Y
+        {charWidth, charShift, charHeight},
+        {0.0f, charShift, 0.0f},
+        {-charWidth, charShift, charHeight},
+        {0.0f, charShift, 0.0f},
+        {0.0f, charShift, 0.0f},
+        {0.0f, charShift, -charHeight},
+        // The Z
+        {-charWidth, charHeight, charShift},
+        {charWidth, charHeight, charShift},
+        {charWidth, charHeight, charShift},
+        {-charWidth, -charHeight, charShift},
+        {-charWidth, -charHeight, charShift},
+        {charWidth, -charHeight, charShift},
+    };
+
+    std::vector<Vertex> vertices;
+    for (const auto &p : letters)
+      vertices.push_back({{p[0], p[1], p[2]}, {0, 0, 1}, {1, 1, 1}});
+    axis_.lines = static_cast<GLsizei>(vertices.size());
+
+    const float red[3] = {1.0f, 0.7f, 0.7f};
+    const float green[3] = {0.7f, 1.0f, 0.7f};
+    const float blue[3] = {0.7f, 0.7f, 1.0f};
+    addArrow(vertices, 0.01, 12, red, 0);
+    addArrow(vertices, 0.01, 12, green, 1);
+    addArrow(vertices, 0.01, 12, blue, 2);
+    axis_.triangles = static_cast<GLsizei>(vertices.size()) - axis_.lines;
+
+    upload(axis_, vertices);
+  }
+
+  draw(axis_, modelView, projection, length, color, white);
+}
+
+/*! Draws an arrow along the positive Z axis, see QGLViewer::drawArrow(). */
+void VisualHints::drawArrow(const GLfloat modelView[16],
+                            const GLfloat projection[16], qreal length,
+                            qreal radius, int nbSubdivisions,
+                            const float color[4]) {
+  if (!program_)
+    initProgram();
+
+  if (radius < 0.0)
+    radius = 0.05 * length;
+
+  // a flat arrow is not visible, a null ratio would not be shaped
+  const qreal ratio = radius / length;
+  if (!(ratio > 0.0))
+    return;
+
+  // the vertex shader shapes the arrow, the buffer only depends on its
+  // subdivisions
+  Geometry &arrow = arrows_[nbSubdivisions];
+  if (!arrow.vao) {
+    std::vector<Vertex> vertices;
+    addArrow(vertices, 0.0, nbSubdivisions, white, 2);
+    arrow.triangles = static_cast<GLsizei>(vertices.size());
+    upload(arrow, vertices);
+  }
+
+  draw(arrow, modelView, projection, length, color, color, ratio);
+}
@@ -0,0 +1,82 @@
+#ifndef QGLVIEWER_VISUAL_HINTS_H
+#define QGLVIEWER_VISUAL_HINTS_H
+
+#include <GL/glew.h>
+#include "config.h"
+#include <map>
+#include <vector>
+
+namespace qglviewer {
+/*! \brief Core profile geometry of the grid, axis and arrows drawn by QGLViewer.
+  \class VisualHints visualHints.h QGLViewer/visualHints.h
+
+  Each hint is built once in a vertex buffer, at unit size, and scaled when
+  drawn: a grid is only rebuilt when its number of subdivisions changes, the
+  axis never, and an arrow is built once per number of subdivisions, its
+  radius to length ratio is applied by the vertex shader. A grid draws with
+  one draw call, an arrow with one and the axis with two (the X, Y and Z
+  letters and the three arrows).
+
+  The matrices are given explicitly (column major, see
+  Camera::getModelViewMatrix() and Camera::getProjectionMatrix()), no fixed
+  function state is used, so that the hints also work in a 3.3+ core context.
+  The current program and vertex array are restored after each draw.
+
+  All the QGLViewer share the instance returned by shared(). */
+class VisualHints {
+public:
+  VisualHints();
+
+  static VisualHints &shared();
+
+  void drawGrid(const GLfloat modelView[16], const GLfloat projection[16],
+                qreal size, int nbSubdivisions, const float color[4]);
+  void drawAxis(const GLfloat modelView[16], const GLfloat projection[16],
+                qreal length, const float color[4]);
+  void drawArrow(const GLfloat modelView[16], const GLfloat projection[16],
+                 qreal length, qreal radius, int nbSubdivisions,
+                 const float color[4]);
+
+  /*! Releases all the GL objects, which are recreated on demand. The GL
+  context must be current. */
+  void release();
+
+private:
+  /*! A vertex array and its buffer. */
+  struct Geometry {
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLsizei lines = 0;     // vertices of the GL_LINES part, drawn first
+    GLsizei triangles = 0; // vertices of the GL_TRIANGLES part
+  };
+  struct Vertex {
+    float position[3];
+    float normal[3];
+    float color[3];
+  };
+
+  void initProgram();
+  void upload(Geometry &geometry, const std::vector<Vertex> &vertices);
+  void destroy(Geometry &geometry);
+  void draw(const Geometry &geometry, const GLfloat modelView[16],
+            const GLfloat projection[16], qreal scale,
+            const float lineColor[4], const float triangleColor[4],
+            qreal arrowRatio = 0.0);
+
+  static void addArrow(std::vector<Vertex> &vertices, qreal ratio,
+                       int nbSubdivisions, const float color[3], int axis);
+
+  GLuint program_;
+  GLint modelViewLocation_, projectionLocation_, scaleLocation_,
+      arrowRatioLocation_, colorLocation_, litLocation_;
+
+  Geometry grid_;
+  int gridSubdivisions_;
+  Geometry axis_;
+  // arrows by nbSubdivisions
+  std::map<int, Geometry> arrows_;
+};
+
+} // namespace qglviewer
+
+#endif // QGLVIEWER_VISUAL_HINTS_H
@@ -1,5 +1,105 @@
 #include "file_manager.h"
 
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// a mapped file, with the stamp it was mapped with
+struct FileMapping
+{
+	const std::byte* data = nullptr;
+	std::size_t size = 0;
+	std::filesystem::file_time_type time;
+#ifdef _WIN32
+	std::vector<std::byte> buffer;
+#else
+	void* address = MAP_FAILED;
+	~FileMapping() {
+		if (address != MAP_FAILED)
+			munmap(address, size);
+	}
+#endif
+};
+
+namespace {
+std::mutex cacheMutex;
+std::unordered_map<std::string, std::shared_ptr<const FileMapping>> cache;
+
+void error(const std::string& what, const std::string& filename, const std::string& reason)
+{
+	std::cerr << "ERROR::FILEMANAGER:: cannot " << what << " " << filename << ": " << reason << std::endl;
+}
+
+std::shared_ptr<const FileMapping> load(const std::string& filename, std::filesystem::file_time_type time)
+{
+	auto mapping = std::make_shared<FileMapping>();
+	mapping->time = time;
+#ifdef _WIN32
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) {
+		error("open", filename, std::strerror(errno));
+		return nullptr;
+	}
+	mapping->buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	mapping->data = mapping->buffer.data();
+	mapping->size = mapping->buffer.size();
+#else
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		error("open", filename, std::strerror(errno));
+		return nullptr;
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		error("stat", filename, std::strerror(errno));
+		close(fd);
+		return nullptr;
+	}
+	// an empty file cannot be mapped, its view is just empty
+	mapping->size = static_cast<std::size_t>(status.st_size);
+	if (mapping->size > 0) {
+		mapping->address = mmap(nullptr, mapping->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping->address == MAP_FAILED) {
+			error("map", filename, std::strerror(errno));
+			close(fd);
+			return nullptr;
+		}
+		mapping->data = static_cast<const std::byte*>(mapping->address);
+	}
+	// the mapping holds its own reference on the file
+	close(fd);
+#endif
+	return mapping;
+}
+}
+
+std::size_t FileManager::View::size() const
+{
+	return mapping_ ? mapping_->size : 0;
+}
+
+std::span<const std::byte> FileManager::View::bytes() const
+{
+	return mapping_ ? std::span<const std::byte>(mapping_->data, mapping_->size) : std::span<const std::byte>();
+}
+
+std::string_view FileManager::View::text() const
+{
+	return mapping_ ? std::string_view(reinterpret_cast<const char*>(mapping_->data), mapping_->size) : std::string_view();
+}
+
 FileManager::FileManager()
 {
 }
@@ -8,17 +108,62 @@ FileManager::~FileManager()
 {
 }
 
-std::string FileManager::read(const std::string& filename) {
-    std::ifstream file;
-    file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-	std::stringstream file_stream;
-	try {
-		file.open(filename.c_str());
-    	file_stream << file.rdbuf();
-		file.close();
-    }
-    catch (std::ifstream::failure e) {
-        std::cout << "Error reading Shader File!" << std::endl;
-    }
-	return file_stream.str();
+FileManager::View FileManager::map(const std::string& filename)
+{
+	View view;
+	std::error_code code;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(filename, code);
+	if (code) {
+		error("read", filename, code.message());
+		return view;
+	}
+	std::uintmax_t size = std::filesystem::file_size(filename, code);
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = cache.find(filename);
+	if (it != cache.end() && it->second->time == time && !code && it->second->size == size) {
+		view.mapping_ = it->second;
+		return view;
+	}
+
+	view.mapping_ = load(filename, time);
+	if (view.mapping_)
+		cache[filename] = view.mapping_;
+	else if (it != cache.end())
+		cache.erase(it);
+	return view;
+}
+
+// WILLNEED starts the reads in the background, parsing the first file
+// overlaps with reading the next ones
+void FileManager::prefetch(const std::vector<std::string>& filenames)
+{
+	for (const std::string& filename : filenames) {
+		View view = map(filename);
+#ifndef _WIN32
+		if (view.size() > 0)
+			madvise(const_cast<std::byte*>(view.mapping_->data), view.size(), MADV_WILLNEED);
+#endif
+	}
+}
+
+void FileManager::evict(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.erase(filename);
+}
+
+void FileManager::clear()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
+
+// the mapping only lives for the copy, the cache does not keep it
+std::string FileManager::read(const std::string& filename)
+{
+	std::shared_ptr<const FileMapping> mapping = load(filename, std::filesystem::file_time_type());
+	if (!mapping || mapping->size == 0)
+		return std::string();
+	return std::string(reinterpret_cast<const char*>(mapping->data), mapping->size);
 }
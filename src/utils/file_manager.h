@@ -1,15 +1,50 @@
 #pragma once
 
-#include <fstream>
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
-#include <sstream>
-#include <iostream>
+#include <string_view>
+#include <vector>
 
+struct FileMapping;
+
+// Files mapped read-only in memory, shared through a cache keyed by path.
+//
+// map() returns a View on the whole file without copying it: shaders, meshes
+// and saved states are parsed in place. The cache maps a file once and maps it
+// again when its modification time or size changed. A View keeps its mapping
+// alive, also after the file is mapped again or evicted, and sees the contents
+// of the file when it was mapped as long as the file is replaced (saved to a
+// new file and renamed) rather than rewritten in place. prefetch() maps a
+// batch of files and asks the kernel to read them ahead, before they are
+// parsed. On Windows the files are read into memory instead.
 class FileManager
 {
 public:
+	class View
+	{
+	public:
+		bool valid() const { return mapping_ != nullptr; };
+		std::size_t size() const;
+		std::span<const std::byte> bytes() const;
+		std::string_view text() const;
+
+	private:
+		friend class FileManager;
+		std::shared_ptr<const FileMapping> mapping_;
+	};
+
 	FileManager();
 	~FileManager();
+
+	// reports the errors and returns an invalid view
+	static View map(const std::string& filename);
+	static void prefetch(const std::vector<std::string>& filenames);
+	static void evict(const std::string& filename);
+	static void clear();
+
+	// copy of the contents, empty when the file cannot be read; the file is
+	// mapped for the copy only, outside of the cache
 	static std::string read(const std::string& filename);
 };
-
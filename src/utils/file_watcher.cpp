@@ -0,0 +1,112 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+long long modificationTime(const std::string& filename)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(filename, error);
+	return error ? 0 : static_cast<long long>(time.time_since_epoch().count());
+}
+}
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+	fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd_ < 0)
+		std::cerr << "ERROR::FILEWATCHER:: inotify unavailable, polling modification times" << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+	if (fd_ >= 0)
+		close(fd_);
+#endif
+}
+
+void FileWatcher::watch(const std::string& filename)
+{
+	std::filesystem::path path(filename);
+	std::string directory = path.parent_path().string();
+	if (directory.empty())
+		directory = ".";
+
+#ifdef __linux__
+	if (fd_ >= 0) {
+		// a directory already watched gives back its descriptor
+		int wd = inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (wd >= 0) {
+			Directory& watched = directories_[wd];
+			watched.path = directory;
+			watched.files[path.filename().string()] = filename;
+			return;
+		}
+		std::cerr << "ERROR::FILEWATCHER:: cannot watch " << directory << std::endl;
+	}
+#endif
+	times_[filename] = modificationTime(filename);
+}
+
+std::vector<std::string> FileWatcher::changes()
+{
+	std::vector<std::string> changed;
+
+#ifdef __linux__
+	if (fd_ >= 0) {
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while ((length = read(fd_, buffer, sizeof(buffer))) > 0) {
+			for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(p)->len) {
+				const inotify_event* event = reinterpret_cast<inotify_event*>(p);
+				auto directory = directories_.find(event->wd);
+				if (directory == directories_.end() || event->len == 0)
+					continue;
+				auto file = directory->second.files.find(event->name);
+				if (file != directory->second.files.end())
+					changed.push_back(file->second);
+			}
+		}
+	}
+#endif
+
+	for (auto& entry : times_) {
+		long long time = modificationTime(entry.first);
+		if (time != entry.second) {
+			entry.second = time;
+			changed.push_back(entry.first);
+		}
+	}
+
+	// a save may be several writes
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+	return changed;
+}
+
+bool FileWatcher::pending() const
+{
+#ifdef __linux__
+	if (fd_ >= 0) {
+		pollfd events = {fd_, POLLIN, 0};
+		if (poll(&events, 1, 0) > 0)
+			return true;
+	}
+#endif
+
+	for (const auto& entry : times_)
+		if (modificationTime(entry.first) != entry.second)
+			return true;
+	return false;
+}
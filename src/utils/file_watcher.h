@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports the files modified since the last call to changes().
+//
+// On Linux the parent directories are watched with inotify, which also sees
+// the files that editors save by writing a copy and renaming it. changes()
+// only drains a non blocking descriptor, it is cheap enough to be called
+// every frame. Elsewhere the modification times are compared instead.
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	void watch(const std::string& filename);
+	// watched files written since the last call, each reported once, as given to watch()
+	std::vector<std::string> changes();
+	// true when changes() may report files, without draining them; on Linux
+	// any write in a watched directory counts
+	bool pending() const;
+
+private:
+	struct Directory {
+		std::string path;
+		std::unordered_map<std::string, std::string> files; // name in the directory -> filename
+	};
+
+	int fd_ = -1;
+	std::unordered_map<int, Directory> directories_; // by watch descriptor
+	std::unordered_map<std::string, long long> times_; // filename -> modification time, without inotify
+};
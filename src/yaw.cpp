@@ -5,6 +5,7 @@
 #include <GL/glew.h> 
 #include <GLFW/glfw3.h>
 #include "TestMyGLFWWindow.h"
+#include "opengl/program_cache.h"
 #include <iostream>
 
 bool Yaw::init() {
@@ -14,8 +15,10 @@ bool Yaw::init() {
 	triangle2.init();
 
     opengGLWindow1 = new TestMyGLFWWindow("Test OpenGl 1", 200,200);
-    opengGLWindow2 = new TestMyGLFWWindow("Test OpenGl 2", 200,200);
+    opengGLWindow2 = new TestMyGLFWWindow("Test OpenGl 2 (MSAA 4x)", 200,200,4);
     
+    setPacingOverlay(true);
+
     viewer.initializeGL();
     viewer.resizeGL(width(), height());
 
@@ -27,38 +30,72 @@ void Yaw::ui() {
     ImGui::Begin("Triangle Position/Color");
     static float rotation = 0.0;
     if (ImGui::SliderFloat("rotation", &rotation, 0, 2 * M_PI))
-        triangle.setUniform("rotation", rotation);
+        triangle.setRotation(rotation);
 
     static float translation[] = {0.0, 0.0};
     if (ImGui::SliderFloat2("position", translation, -1.0, 1.0))
-        triangle.setUniform("translation", translation[0], translation[1]);
+        triangle.setTranslation(translation[0], translation[1]);
     
     static float color[4] = { 1.0f,1.0f,1.0f,1.0f };
     if (ImGui::ColorEdit3("color", color))
-        triangle.setUniform("color", color[0], color[1], color[2]);
+        triangle.setColor(color[0], color[1], color[2]);
     
     ImGui::End();
 
     opengGLWindow1->ui();
     opengGLWindow2->ui();
+
+    // state changes of the previous frame
+    const RenderQueue::Stats& stats = renderQueue().stats();
+    ImGui::Begin("Render queue");
+    ImGui::Text("packets: %d", stats.packets);
+    ImGui::Text("targets: %d (%d)", stats.targetChanges, stats.submittedTargetChanges);
+    ImGui::Text("programs: %d (%d)", stats.programChanges, stats.submittedProgramChanges);
+    ImGui::Text("vertex arrays: %d (%d)", stats.vaoChanges, stats.submittedVaoChanges);
+    ImGui::Text("state changes saved: %d", stats.saved());
+    ImGui::Separator();
+    for (ImGuiGLFWWindow* window : {opengGLWindow1, opengGLWindow2})
+        ImGui::Text("%s: %u rendered, %u skipped", window->name().c_str(), window->renderedFrames(), window->skippedFrames());
+    ImGui::End();
 }
 
 void Yaw::draw() {   
 
     viewer.paintGL();
     
-    triangle.draw();
-    triangle2.draw();
+    triangle.submit(renderQueue());
+    triangle2.submit(renderQueue());
     
-    opengGLWindow1->draw();
-    opengGLWindow2->draw();
+    opengGLWindow1->draw(renderQueue());
+    opengGLWindow2->draw(renderQueue());
+}
+
+// a saved shader needs frames until its new program is swapped in
+bool Yaw::animating() {
+    return ProgramCache::instance().pending();
+}
+
+// viewer animation, keyframe interpolation, spinning... all run on timers,
+// the loop sleeps until the next one is due
+double Yaw::nextTimeout() {
+    int64_t ms = Metronom::nextTimeout();
+    return ms < 0 ? -1.0 : ms / 1000.0;
 }
 
 void Yaw::update() {
-    viewer.update();
+    // timeouts first: they move the camera and the frames drawn below
+    Metronom::processTimers();
+    // shaders reloaded after a save: the panels see it in their triangle
+    // version, the main window is drawn again here
+    if (ProgramCache::instance().update())
+        postRedraw();
+    viewer.writeCameraBlock(uniforms());
+
+    triangle.update(uniforms());
+    triangle2.update(uniforms());
     
-    opengGLWindow1->update();
-    opengGLWindow2->update();
+    opengGLWindow1->update(uniforms());
+    opengGLWindow2->update(uniforms());
 }
 
 
@@ -12,6 +12,8 @@ protected:
     virtual void draw();
     virtual void update();
     virtual bool init();
+    virtual bool animating();
+    virtual double nextTimeout();
 
 private :
   Triangle triangle;